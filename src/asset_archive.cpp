@@ -0,0 +1,92 @@
+#include "asset_archive.h"
+#include "lz_codec.h"
+#include <cstring>
+#include <iostream>
+
+AssetArchive::AssetArchive() {
+    std::memset(&header, 0, sizeof(header));
+}
+
+AssetArchive::~AssetArchive() {
+    close();
+}
+
+bool AssetArchive::open(const std::string& filename) {
+    close();
+
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    const unsigned char* data = file.getData();
+    size_t size = file.getSize();
+
+    if (size < sizeof(AssetArchiveHeader)) {
+        std::cerr << "Asset archive too small: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ASSET_ARCHIVE_VERSION) {
+        std::cerr << "Invalid asset archive format: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    uint64_t entriesEnd = header.entryOffset + static_cast<uint64_t>(header.entryCount) * sizeof(AssetArchiveEntry);
+    uint64_t stringsEnd = static_cast<uint64_t>(header.stringTableOffset) + header.stringTableSize;
+    if (entriesEnd > size || stringsEnd > size) {
+        std::cerr << "Truncated asset archive: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(data + header.stringTableOffset);
+
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        AssetArchiveEntry entry;
+        std::memcpy(&entry, data + header.entryOffset + i * sizeof(AssetArchiveEntry), sizeof(entry));
+
+        if (static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > header.stringTableSize ||
+            entry.dataOffset + entry.storedSize > size ||
+            entry.rawSize != static_cast<uint64_t>(entry.pitch) * entry.height ||
+            (!(entry.flags & ASSET_ARCHIVE_COMPRESSED) && entry.storedSize != entry.rawSize)) {
+            std::cerr << "Skipping corrupt asset archive entry " << i << std::endl;
+            continue;
+        }
+
+        entries[std::string(strings + entry.nameOffset, entry.nameLength)] = entry;
+    }
+
+    std::cout << "Asset archive " << filename << " mapped with " << entries.size() << " textures" << std::endl;
+    return true;
+}
+
+void AssetArchive::close() {
+    entries.clear();
+    file.close();
+    std::memset(&header, 0, sizeof(header));
+}
+
+const AssetArchiveEntry* AssetArchive::findEntry(const std::string& id) const {
+    auto it = entries.find(id);
+    return (it != entries.end()) ? &it->second : nullptr;
+}
+
+const unsigned char* AssetArchive::getPixels(const AssetArchiveEntry& entry, std::vector<unsigned char>& scratch) const {
+    const unsigned char* stored = file.getData() + entry.dataOffset;
+
+    if (!(entry.flags & ASSET_ARCHIVE_COMPRESSED)) {
+        return stored;
+    }
+
+    scratch.resize(entry.rawSize);
+    if (!lzDecompress(stored, entry.storedSize, scratch.data(), scratch.size())) {
+        return nullptr;
+    }
+
+    return scratch.data();
+}
@@ -0,0 +1,68 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "mapped_file.h"
+
+// On-disk layout written by the asset packer:
+//   AssetArchiveHeader
+//   AssetArchiveEntry[entryCount]   at entryOffset
+//   texture id strings              at stringTableOffset
+//   pixel data, 16 byte aligned     at each entry's dataOffset
+// Pixels are stored in the header's SDL pixel format, rows packed to pitch.
+const char ASSET_ARCHIVE_MAGIC[4] = {'M', 'P', 'A', 'K'};
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+const uint32_t ASSET_ARCHIVE_COMPRESSED = 1;
+
+struct AssetArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t pixelFormat;
+    uint32_t entryCount;
+    uint32_t entryOffset;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint32_t reserved;
+};
+
+struct AssetArchiveEntry {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t flags;
+    uint64_t dataOffset;
+    uint64_t storedSize;
+    uint64_t rawSize;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 32, "AssetArchiveHeader layout changed");
+static_assert(sizeof(AssetArchiveEntry) == 48, "AssetArchiveEntry layout changed");
+
+class AssetArchive {
+public:
+    AssetArchive();
+    ~AssetArchive();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    uint32_t getPixelFormat() const { return header.pixelFormat; }
+    const AssetArchiveEntry* findEntry(const std::string& id) const;
+
+    // Uncompressed entries point straight into the mapping, compressed ones
+    // are expanded into scratch. Returns nullptr on corrupt data.
+    const unsigned char* getPixels(const AssetArchiveEntry& entry, std::vector<unsigned char>& scratch) const;
+
+private:
+    MappedFile file;
+    AssetArchiveHeader header;
+    std::unordered_map<std::string, AssetArchiveEntry> entries;
+};
+
+#endif // ASSET_ARCHIVE_H
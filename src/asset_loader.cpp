@@ -0,0 +1,142 @@
+#include "asset_loader.h"
+#include <SDL2/SDL_Image.h>
+#include <algorithm>
+#include <iostream>
+
+AssetLoader::AssetLoader()
+    : stopping(false), targetFormat(SDL_PIXELFORMAT_UNKNOWN), queuedCount(0), finishedCount(0) {
+}
+
+AssetLoader::~AssetLoader() {
+    shutdown();
+}
+
+void AssetLoader::start(int workerCount) {
+    if (!workers.empty()) return;
+
+    if (workerCount <= 0) {
+        workerCount = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, workerCount);
+    }
+
+    stopping = false;
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+
+    std::cout << "Asset loader started with " << workerCount << " worker threads" << std::endl;
+}
+
+void AssetLoader::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobCondition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& image : decoded) {
+        if (image.surface) {
+            SDL_FreeSurface(image.surface);
+        }
+    }
+    decoded.clear();
+}
+
+void AssetLoader::queueImage(const std::string& id, const std::string& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({id, filePath});
+        queuedCount++;
+    }
+    jobCondition.notify_one();
+}
+
+bool AssetLoader::popDecoded(DecodedImage& image) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (decoded.empty()) {
+        return false;
+    }
+
+    image = decoded.front();
+    decoded.pop_front();
+    finishedCount++;
+    return true;
+}
+
+int AssetLoader::getQueuedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queuedCount;
+}
+
+int AssetLoader::getFinishedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishedCount;
+}
+
+bool AssetLoader::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishedCount == queuedCount;
+}
+
+void AssetLoader::resetProgress() {
+    std::lock_guard<std::mutex> lock(mutex);
+    queuedCount -= finishedCount;
+    finishedCount = 0;
+}
+
+void AssetLoader::workerLoop() {
+    while (true) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (stopping) return;
+
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        DecodedImage image = decode(job);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            if (image.surface) {
+                SDL_FreeSurface(image.surface);
+            }
+            return;
+        }
+        decoded.push_back(image);
+    }
+}
+
+DecodedImage AssetLoader::decode(const DecodeJob& job) const {
+    DecodedImage image{job.id, job.filePath, nullptr, ""};
+
+    SDL_Surface* surface = IMG_Load(job.filePath.c_str());
+    if (!surface) {
+        image.error = IMG_GetError();
+        return image;
+    }
+
+    // Converting here keeps SDL_CreateTextureFromSurface from doing it on the main thread.
+    if (targetFormat != SDL_PIXELFORMAT_UNKNOWN && surface->format->format != targetFormat) {
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, targetFormat, 0);
+        if (converted) {
+            SDL_FreeSurface(surface);
+            surface = converted;
+        }
+    }
+
+    image.surface = surface;
+    return image;
+}
@@ -0,0 +1,61 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct DecodedImage {
+    std::string id;
+    std::string filePath;
+    SDL_Surface* surface;
+    std::string error;
+};
+
+// Decodes image files on a pool of worker threads. Decoded surfaces are handed
+// back through a queue so the main thread can create the SDL textures.
+class AssetLoader {
+public:
+    AssetLoader();
+    ~AssetLoader();
+
+    void start(int workerCount = 0);
+    void shutdown();
+
+    void setTargetFormat(Uint32 format) { targetFormat = format; }
+
+    void queueImage(const std::string& id, const std::string& filePath);
+    bool popDecoded(DecodedImage& image);
+
+    int getQueuedCount() const;
+    int getFinishedCount() const;
+    bool isIdle() const;
+    void resetProgress();
+
+private:
+    struct DecodeJob {
+        std::string id;
+        std::string filePath;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<DecodeJob> jobs;
+    std::deque<DecodedImage> decoded;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobCondition;
+
+    bool stopping;
+    Uint32 targetFormat;
+    int queuedCount;
+    int finishedCount;
+
+    void workerLoop();
+    DecodedImage decode(const DecodeJob& job) const;
+};
+
+#endif // ASSET_LOADER_H
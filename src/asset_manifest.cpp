@@ -0,0 +1,66 @@
+#include "asset_manifest.h"
+#include <fstream>
+#include <iostream>
+#include <json.hpp>
+
+AssetManifest::AssetManifest() : textureBudgetMB(0) {
+}
+
+AssetManifest::~AssetManifest() {
+}
+
+bool AssetManifest::load(const std::string& filename) {
+    try {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open asset manifest: " << filename << std::endl;
+            return false;
+        }
+
+        nlohmann::json manifestJson;
+        file >> manifestJson;
+        file.close();
+
+        if (!manifestJson.contains("textures")) {
+            std::cerr << "Invalid asset manifest format" << std::endl;
+            return false;
+        }
+
+        texturePaths.clear();
+        sceneTextures.clear();
+
+        for (const auto& entry : manifestJson["textures"].items()) {
+            texturePaths[entry.key()] = entry.value().get<std::string>();
+        }
+
+        textureBudgetMB = manifestJson.value("textureBudgetMB", 0);
+
+        if (manifestJson.contains("scenes")) {
+            for (const auto& entry : manifestJson["scenes"].items()) {
+                sceneTextures[entry.key()] = entry.value().get<std::vector<std::string>>();
+            }
+        }
+
+        std::cout << "Asset manifest loaded with " << texturePaths.size() << " textures" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading asset manifest: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool AssetManifest::hasTexture(const std::string& id) const {
+    return texturePaths.find(id) != texturePaths.end();
+}
+
+std::string AssetManifest::getTexturePath(const std::string& id) const {
+    auto it = texturePaths.find(id);
+    return (it != texturePaths.end()) ? it->second : "";
+}
+
+const std::vector<std::string>& AssetManifest::getSceneTextures(const std::string& scene) const {
+    static const std::vector<std::string> empty;
+
+    auto it = sceneTextures.find(scene);
+    return (it != sceneTextures.end()) ? it->second : empty;
+}
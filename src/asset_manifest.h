@@ -0,0 +1,30 @@
+#ifndef ASSET_MANIFEST_H
+#define ASSET_MANIFEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// Maps texture ids to files and lists the textures each scene references.
+class AssetManifest {
+public:
+    AssetManifest();
+    ~AssetManifest();
+
+    bool load(const std::string& filename);
+
+    bool hasTexture(const std::string& id) const;
+    std::string getTexturePath(const std::string& id) const;
+    const std::map<std::string, std::string>& getTextures() const { return texturePaths; }
+
+    const std::vector<std::string>& getSceneTextures(const std::string& scene) const;
+
+    int getTextureBudgetMB() const { return textureBudgetMB; }
+
+private:
+    std::map<std::string, std::string> texturePaths;
+    std::map<std::string, std::vector<std::string>> sceneTextures;
+    int textureBudgetMB;
+};
+
+#endif // ASSET_MANIFEST_H
@@ -0,0 +1,102 @@
+#include "atomic_file.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#endif
+
+#ifdef _WIN32
+
+bool writeFileAtomic(const std::string& filename, const void* data, size_t size) {
+    std::string tempName = filename + ".tmp";
+
+    HANDLE file = CreateFileA(tempName.c_str(), GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file for writing: " << tempName << std::endl;
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    bool ok = true;
+    while (ok && written < size) {
+        DWORD chunk = 0;
+        DWORD request = static_cast<DWORD>(std::min<size_t>(size - written, 1u << 30));
+        ok = WriteFile(file, bytes + written, request, &chunk, nullptr) != 0;
+        written += chunk;
+    }
+
+    ok = ok && FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+
+    if (!ok || !MoveFileExA(tempName.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        std::cerr << "Failed to write " << filename << " (error " << GetLastError() << ")" << std::endl;
+        DeleteFileA(tempName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+#else
+
+bool writeFileAtomic(const std::string& filename, const void* data, size_t size) {
+    std::string tempName = filename + ".tmp";
+
+    int fd = ::open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open file for writing: " << tempName << std::endl;
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    while (written < size) {
+        ssize_t chunk = ::write(fd, bytes + written, size - written);
+        if (chunk < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        written += static_cast<size_t>(chunk);
+    }
+
+    bool ok = written == size && ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Failed to write " << filename << ": " << std::strerror(errno) << std::endl;
+        ::unlink(tempName.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable.
+    std::string directory = ".";
+    size_t slash = filename.find_last_of('/');
+    if (slash != std::string::npos) {
+        directory = filename.substr(0, slash);
+    }
+
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Writes to filename + ".tmp", flushes it to disk and renames it over the
+// target. A crash leaves either the old file or the new one, never half of it.
+bool writeFileAtomic(const std::string& filename, const void* data, size_t size);
+
+#endif // ATOMIC_FILE_H
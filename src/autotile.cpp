@@ -0,0 +1,24 @@
+#include "autotile.h"
+
+const char* const Autotiler::HALF_TEXTURE = "border2";
+const char* const Autotiler::QUARTER_TEXTURE = "border1";
+const char* const Autotiler::DEFAULT_SOLID_TEXTURE = "border_grass";
+
+bool Autotiler::isBorderTexture(const std::string& textureID) {
+    return isSolidBorder(textureID) || textureID == HALF_TEXTURE || textureID == QUARTER_TEXTURE;
+}
+
+bool Autotiler::isSolidBorder(const std::string& textureID) {
+    return textureID == "border_grass" || textureID == "border_path" || textureID == "border_water";
+}
+
+bool Autotiler::isLimitTexture(const std::string& textureID) {
+    return textureID == "base_limit";
+}
+
+int Autotiler::updateMap(MapData& data) {
+    if (!data.autotile) return 0;
+
+    MapDataAutotileGrid grid(data);
+    return updateAll(grid);
+}
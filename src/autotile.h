@@ -0,0 +1,172 @@
+#ifndef AUTOTILE_H
+#define AUTOTILE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include "map_data.h"
+
+// Picks border object textures from their surroundings. A border tile is
+// "covered" on a side when the neighbour there is another border tile, the
+// map limit, or off the map. The 8-neighbour coverage mask goes through a
+// lookup table to one of three densities: fully enclosed tiles get the solid
+// border of their family (border_grass, border_path, border_water), tiles
+// open on one side or at an inner corner get border2, everything else fades
+// out with border1. Only maps that opt in with MapData::autotile are
+// touched, the shipped maps were bordered by hand and do not follow these
+// rules.
+enum class AutotileVariant : uint8_t {
+    FULL,
+    HALF,
+    QUARTER
+};
+
+// Neighbour bits, clockwise from north.
+enum AutotileNeighbour : uint8_t {
+    AUTOTILE_N = 1 << 0,
+    AUTOTILE_NE = 1 << 1,
+    AUTOTILE_E = 1 << 2,
+    AUTOTILE_SE = 1 << 3,
+    AUTOTILE_S = 1 << 4,
+    AUTOTILE_SW = 1 << 5,
+    AUTOTILE_W = 1 << 6,
+    AUTOTILE_NW = 1 << 7
+};
+
+constexpr AutotileVariant autotileVariantForMask(uint8_t mask) {
+    const uint8_t sides = AUTOTILE_N | AUTOTILE_E | AUTOTILE_S | AUTOTILE_W;
+    const uint8_t corners = AUTOTILE_NE | AUTOTILE_SE | AUTOTILE_SW | AUTOTILE_NW;
+
+    int coveredSides = 0;
+    for (int bit = 0; bit < 8; bit += 2) {
+        if (mask & (1 << bit)) coveredSides++;
+    }
+
+    if ((mask & sides) == sides) {
+        return (mask & corners) == corners ? AutotileVariant::FULL : AutotileVariant::HALF;
+    }
+    return coveredSides == 3 ? AutotileVariant::HALF : AutotileVariant::QUARTER;
+}
+
+constexpr std::array<AutotileVariant, 256> buildAutotileTable() {
+    std::array<AutotileVariant, 256> table{};
+    for (int mask = 0; mask < 256; mask++) {
+        table[mask] = autotileVariantForMask(static_cast<uint8_t>(mask));
+    }
+    return table;
+}
+
+constexpr std::array<AutotileVariant, 256> AUTOTILE_TABLE = buildAutotileTable();
+
+static_assert(AUTOTILE_TABLE[0xFF] == AutotileVariant::FULL, "enclosed tiles must be solid");
+static_assert(AUTOTILE_TABLE[0x00] == AutotileVariant::QUARTER, "isolated tiles must fade out");
+
+// Grid is anything with getWidth(), getHeight(), getObject(x, y),
+// getGround(x, y) and setObject(x, y, textureID). MapDataAutotileGrid wraps
+// MapData, MapEditor wraps its TileMap so changes land in the undo history.
+class Autotiler {
+public:
+    static bool isBorderTexture(const std::string& textureID);
+    static bool isSolidBorder(const std::string& textureID);
+    static bool isLimitTexture(const std::string& textureID);
+
+    template<typename Grid>
+    static uint8_t getNeighbourMask(const Grid& grid, int x, int y) {
+        static const int offsets[8][2] = {{0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}};
+
+        uint8_t mask = 0;
+        for (int i = 0; i < 8; i++) {
+            int nx = x + offsets[i][0];
+            int ny = y + offsets[i][1];
+
+            bool covered = nx < 0 || ny < 0 || nx >= grid.getWidth() || ny >= grid.getHeight() ||
+                           isBorderTexture(grid.getObject(nx, ny)) || isLimitTexture(grid.getGround(nx, ny));
+            if (covered) {
+                mask |= 1 << i;
+            }
+        }
+        return mask;
+    }
+
+    // Re-evaluates one tile, returns true if its texture changed.
+    template<typename Grid>
+    static bool updateTile(Grid& grid, int x, int y) {
+        const std::string current = grid.getObject(x, y);
+        if (!isBorderTexture(current)) return false;
+
+        std::string wanted;
+        switch (AUTOTILE_TABLE[getNeighbourMask(grid, x, y)]) {
+            case AutotileVariant::FULL:
+                wanted = isSolidBorder(current) ? current : findSolidFamily(grid, x, y);
+                break;
+            case AutotileVariant::HALF:
+                wanted = HALF_TEXTURE;
+                break;
+            case AutotileVariant::QUARTER:
+                wanted = QUARTER_TEXTURE;
+                break;
+        }
+
+        if (wanted == current) return false;
+
+        grid.setObject(x, y, wanted);
+        return true;
+    }
+
+    // A change only affects the masks of the tile and its eight neighbours.
+    template<typename Grid>
+    static int updateRegion(Grid& grid, int minX, int minY, int maxX, int maxY) {
+        int changed = 0;
+        for (int y = std::max(0, minY - 1); y <= std::min(grid.getHeight() - 1, maxY + 1); y++) {
+            for (int x = std::max(0, minX - 1); x <= std::min(grid.getWidth() - 1, maxX + 1); x++) {
+                if (updateTile(grid, x, y)) changed++;
+            }
+        }
+        return changed;
+    }
+
+    template<typename Grid>
+    static int updateAll(Grid& grid) {
+        return updateRegion(grid, 0, 0, grid.getWidth() - 1, grid.getHeight() - 1);
+    }
+
+    // Whole-map pass run when a map is loaded, maps without the autotile
+    // flag are left as they are.
+    static int updateMap(MapData& data);
+
+private:
+    static const char* const HALF_TEXTURE;
+    static const char* const QUARTER_TEXTURE;
+    static const char* const DEFAULT_SOLID_TEXTURE;
+
+    template<typename Grid>
+    static std::string findSolidFamily(const Grid& grid, int x, int y) {
+        static const int sides[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+        for (const auto& side : sides) {
+            int nx = x + side[0];
+            int ny = y + side[1];
+            if (nx < 0 || ny < 0 || nx >= grid.getWidth() || ny >= grid.getHeight()) continue;
+
+            const std::string& neighbour = grid.getObject(nx, ny);
+            if (isSolidBorder(neighbour)) return neighbour;
+        }
+        return DEFAULT_SOLID_TEXTURE;
+    }
+};
+
+class MapDataAutotileGrid {
+public:
+    explicit MapDataAutotileGrid(MapData& data) : data(data) {}
+
+    int getWidth() const { return data.width; }
+    int getHeight() const { return data.height; }
+    const std::string& getObject(int x, int y) const { return data.getTexture(data.objects[data.index(x, y)]); }
+    const std::string& getGround(int x, int y) const { return data.getTexture(data.ground[data.index(x, y)]); }
+    void setObject(int x, int y, const std::string& textureID) { data.objects[data.index(x, y)] = data.internTexture(textureID); }
+
+private:
+    MapData& data;
+};
+
+#endif // AUTOTILE_H
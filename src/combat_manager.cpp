@@ -24,6 +24,7 @@ void CombatManager::update() {
         enemy->update();
     }
 
+    updateThreatSources();
     cleanupDeadEnemies();
 
     if (isWaveComplete()) {
@@ -48,8 +49,16 @@ void CombatManager::update() {
 void CombatManager::render(Renderer& renderer) {
     if (!inCombat) return;
 
+    // Enemies under the fog of war stay hidden.
+    const VisibilityField& visibility = tileMap->getVisibility();
     for (auto enemy : enemies) {
-        enemy->render(renderer);
+        SDL_Rect collider = enemy->getCollider();
+        int gridX, gridY;
+        tileMap->pixelToGrid(collider.x + collider.w / 2, collider.y + collider.h / 2, gridX, gridY);
+
+        if (!visibility.hasViewers() || visibility.isVisible(gridX, gridY)) {
+            enemy->render(renderer);
+        }
     }
 
     std::string waveText = "Wave: " + std::to_string(currentWave) + "/" + std::to_string(maxWaves);
@@ -75,6 +84,7 @@ void CombatManager::endCombat() {
         delete enemy;
     }
     enemies.clear();
+    clearThreatField();
 
     std::cout << "Combat ended - Returning to city" << std::endl;
 }
@@ -109,6 +119,7 @@ void CombatManager::spawnWave() {
         delete enemy;
     }
     enemies.clear();
+    clearThreatField();
 
     auto spawnPositions = getValidSpawnPositions();
     if (spawnPositions.empty()) {
@@ -141,9 +152,45 @@ void CombatManager::spawnWave() {
         enemies.push_back(enemy);
     }
 
+    rebuildThreatField();
+
     std::cout << "Wave " << currentWave << " spawned with " << enemies.size() << " enemies" << std::endl;
 }
 
+void CombatManager::getEnemyGridPosition(const Enemy* enemy, int& gridX, int& gridY) const {
+    SDL_Rect collider = enemy->getCollider();
+    tileMap->pixelToGrid(collider.x + collider.w / 2, collider.y + collider.h / 2, gridX, gridY);
+}
+
+void CombatManager::rebuildThreatField() {
+    int attackRange = enemies.empty() ? 1 : enemies.front()->getAttackRange();
+    threatField.reset(tileMap, ENEMY_MOVE_RANGE, attackRange);
+    threatSources.clear();
+
+    for (auto enemy : enemies) {
+        int gridX, gridY;
+        getEnemyGridPosition(enemy, gridX, gridY);
+        threatSources[enemy] = threatField.addSource(gridX, gridY);
+    }
+}
+
+// Sources only re-expand when their enemy crossed into another tile.
+void CombatManager::updateThreatSources() {
+    for (auto enemy : enemies) {
+        auto it = threatSources.find(enemy);
+        if (it == threatSources.end()) continue;
+
+        int gridX, gridY;
+        getEnemyGridPosition(enemy, gridX, gridY);
+        threatField.moveSource(it->second, gridX, gridY);
+    }
+}
+
+void CombatManager::clearThreatField() {
+    threatField.reset(tileMap, ENEMY_MOVE_RANGE, 1);
+    threatSources.clear();
+}
+
 std::vector<std::pair<int, int>> CombatManager::getValidSpawnPositions() const {
     std::vector<std::pair<int, int>> validPositions;
 
@@ -170,28 +217,50 @@ std::vector<std::pair<int, int>> CombatManager::getValidSpawnPositions() const {
 void CombatManager::executeEnemyTurns() {
     if (enemies.empty()) return;
 
-    for (auto enemy : enemies) {
+    int playerGridX, playerGridY;
+    tileMap->pixelToGrid(player->getX(), player->getY(), playerGridX, playerGridY);
+
+    planner.beginTurn(tileMap, playerGridX, playerGridY);
+
+    enemyTiles.resize(enemies.size());
+    for (size_t i = 0; i < enemies.size(); i++) {
+        tileMap->pixelToGrid(enemies[i]->getX(), enemies[i]->getY(), enemyTiles[i].first, enemyTiles[i].second);
+        planner.reserveStart(static_cast<int>(i), enemyTiles[i].first, enemyTiles[i].second);
+    }
+
+    planOrder.clear();
+    for (size_t i = 0; i < enemies.size(); i++) {
+        Enemy* enemy = enemies[i];
         enemy->calculateAttackTargets(tileMap, player);
 
         if (enemy->canAttackPlayer()) {
             player->setHealth(player->getHealth() - enemy->getDamage());
             std::cout << "Enemy attacked player for " << enemy->getDamage() << " damage" << std::endl;
+            planner.holdPosition(static_cast<int>(i), enemyTiles[i].first, enemyTiles[i].second);
+        } else if (enemy->isCurrentlyMoving()) {
+            // Still walking last turn's step, it ends up on the tile it is heading for.
+            int targetGridX, targetGridY;
+            tileMap->pixelToGrid(enemy->getTargetX(), enemy->getTargetY(), targetGridX, targetGridY);
+            planner.holdPosition(static_cast<int>(i), targetGridX, targetGridY);
         } else {
-            if (!enemy->isCurrentlyMoving()) {
-                int enemyGridX, enemyGridY;
-                tileMap->pixelToGrid(enemy->getX(), enemy->getY(), enemyGridX, enemyGridY);
-
-                int playerGridX, playerGridY;
-                tileMap->pixelToGrid(player->getX(), player->getY(), playerGridX, playerGridY);
-
-                auto path = tileMap->findPath(enemyGridX, enemyGridY, playerGridX, playerGridY);
-                if (!path.empty() && path.size() > 1) {
-                    int tileSize = tileMap->getTileSize();
-                    float targetX = path[1].first * tileSize;
-                    float targetY = path[1].second * tileSize;
-                    enemy->setTargetPosition(targetX, targetY);
-                }
-            }
+            planOrder.push_back(static_cast<int>(i));
+        }
+    }
+
+    // Enemies closest to the player plan first, the rest route around them.
+    std::sort(planOrder.begin(), planOrder.end(), [this](int a, int b) {
+        int distanceA = planner.getGoalDistance(enemyTiles[a].first, enemyTiles[a].second);
+        int distanceB = planner.getGoalDistance(enemyTiles[b].first, enemyTiles[b].second);
+        if (distanceA < 0) return false;
+        if (distanceB < 0) return true;
+        return distanceA < distanceB || (distanceA == distanceB && a < b);
+    });
+
+    int tileSize = tileMap->getTileSize();
+    for (int i : planOrder) {
+        int nextX, nextY;
+        if (planner.planStep(i, enemyTiles[i].first, enemyTiles[i].second, enemies[i]->getAttackRange(), nextX, nextY)) {
+            enemies[i]->setTargetPosition(nextX * tileSize, nextY * tileSize);
         }
     }
 }
@@ -201,6 +270,13 @@ void CombatManager::cleanupDeadEnemies() {
     while (it != enemies.end()) {
         if ((*it)->isDead()) {
             std::cout << "Enemy defeated!" << std::endl;
+
+            auto source = threatSources.find(*it);
+            if (source != threatSources.end()) {
+                threatField.removeSource(source->second);
+                threatSources.erase(source);
+            }
+
             delete *it;
             it = enemies.erase(it);
         } else {
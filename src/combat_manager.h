@@ -1,11 +1,14 @@
 #ifndef COMBAT_MANAGER_H
 #define COMBAT_MANAGER_H
 
+#include <map>
 #include <vector>
 #include "player.h"
 #include "enemy.h"
 #include "tilemap.h"
 #include "renderer.h"
+#include "threat_field.h"
+#include "cooperative_planner.h"
 
 class CombatManager {
 public:
@@ -31,6 +34,11 @@ public:
 
     void handleCombatEvent(int gridX, int gridY);
 
+    // Tiles the living enemies can attack on their next turn, for the AI and
+    // the player's move preview.
+    ThreatField& getThreatField() { return threatField; }
+    int getThreatAt(int gridX, int gridY) const { return threatField.getThreat(gridX, gridY); }
+
 private:
     Player* player;
     TileMap* tileMap;
@@ -43,10 +51,25 @@ private:
 
     bool playerTurn;
 
+    // Enemies step one tile per turn.
+    static const int ENEMY_MOVE_RANGE = 1;
+    ThreatField threatField;
+    std::map<Enemy*, int> threatSources;
+
+    // Enemy moves are planned together so no two end up on one tile.
+    CooperativePlanner planner;
+    std::vector<std::pair<int, int>> enemyTiles;
+    std::vector<int> planOrder;
+
     void executeEnemyTurns();
     void cleanupDeadEnemies();
     void checkCombatState();
 
+    void getEnemyGridPosition(const Enemy* enemy, int& gridX, int& gridY) const;
+    void rebuildThreatField();
+    void updateThreatSources();
+    void clearThreatField();
+
     std::vector<std::pair<int, int>> getValidSpawnPositions() const;
 };
 
@@ -0,0 +1,218 @@
+#include "cooperative_planner.h"
+#include <algorithm>
+
+namespace {
+
+const int GOAL_AGENT = -1;
+const int NO_AGENT = -2;
+
+// Waiting is a move too, it keeps the agent in place for one step.
+const int MOVE_X[5] = {0, 0, 1, 0, -1};
+const int MOVE_Y[5] = {0, -1, 0, 1, 0};
+
+}
+
+CooperativePlanner::CooperativePlanner(int window)
+    : tileMap(nullptr), window(std::max(1, window)), width(0), height(0), cells(0),
+      turnStamp(0), searchStamp(0) {
+}
+
+void CooperativePlanner::beginTurn(const TileMap* tileMap, int goalX, int goalY) {
+    this->tileMap = tileMap;
+
+    int newWidth = tileMap ? tileMap->getGridWidth() : 0;
+    int newHeight = tileMap ? tileMap->getGridHeight() : 0;
+    if (newWidth != width || newHeight != height) {
+        width = newWidth;
+        height = newHeight;
+        cells = width * height;
+
+        size_t nodes = static_cast<size_t>(window + 1) * cells;
+        reservedStamps.assign(nodes, 0);
+        reservedBy.assign(nodes, NO_AGENT);
+        nodeStamps.assign(nodes, 0);
+        nodeParents.assign(nodes, -1);
+        turnStamp = 0;
+        searchStamp = 0;
+    }
+
+    // Wrapping around resets the stamps so old ones can't collide.
+    if (++turnStamp == 0) {
+        std::fill(reservedStamps.begin(), reservedStamps.end(), 0);
+        turnStamp = 1;
+    }
+
+    computeGoalDistances(goalX, goalY);
+
+    if (tileMap && tileMap->isValidGridPosition(goalX, goalY)) {
+        for (int time = 0; time <= window; time++) {
+            reserve(GOAL_AGENT, goalY * width + goalX, time);
+        }
+    }
+}
+
+void CooperativePlanner::computeGoalDistances(int goalX, int goalY) {
+    goalDistance.assign(cells, -1);
+    if (!tileMap || !tileMap->isValidGridPosition(goalX, goalY)) return;
+
+    bfsQueue.clear();
+    bfsQueue.push_back(goalY * width + goalX);
+    goalDistance[bfsQueue.front()] = 0;
+
+    for (size_t head = 0; head < bfsQueue.size(); head++) {
+        int cell = bfsQueue[head];
+        int x = cell % width;
+        int y = cell / width;
+
+        for (int i = 1; i < 5; i++) {
+            int neighbourX = x + MOVE_X[i];
+            int neighbourY = y + MOVE_Y[i];
+            if (!tileMap->isWalkable(neighbourX, neighbourY)) continue;
+
+            int neighbour = neighbourY * width + neighbourX;
+            if (goalDistance[neighbour] >= 0) continue;
+
+            goalDistance[neighbour] = goalDistance[cell] + 1;
+            bfsQueue.push_back(neighbour);
+        }
+    }
+}
+
+int CooperativePlanner::getGoalDistance(int gridX, int gridY) const {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) {
+        return -1;
+    }
+
+    return goalDistance[gridY * width + gridX];
+}
+
+void CooperativePlanner::reserve(int agent, int cell, int time) {
+    size_t node = static_cast<size_t>(time) * cells + cell;
+    reservedStamps[node] = turnStamp;
+    reservedBy[node] = agent;
+}
+
+bool CooperativePlanner::isFree(int agent, int cell, int time) const {
+    size_t node = static_cast<size_t>(time) * cells + cell;
+    return reservedStamps[node] != turnStamp || reservedBy[node] == agent;
+}
+
+void CooperativePlanner::holdPosition(int agent, int gridX, int gridY, int fromTime) {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) return;
+
+    for (int time = std::max(0, fromTime); time <= window; time++) {
+        reserve(agent, gridY * width + gridX, time);
+    }
+}
+
+void CooperativePlanner::reserveStart(int agent, int gridX, int gridY) {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) return;
+
+    reserve(agent, gridY * width + gridX, 0);
+    reserve(agent, gridY * width + gridX, 1);
+}
+
+bool CooperativePlanner::planStep(int agent, int gridX, int gridY, int stopDistance, int& nextX, int& nextY) {
+    nextX = gridX;
+    nextY = gridY;
+
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) return false;
+
+    int start = gridY * width + gridX;
+    if (goalDistance[start] < 0) {
+        holdPosition(agent, gridX, gridY);
+        return false;
+    }
+
+    if (++searchStamp == 0) {
+        std::fill(nodeStamps.begin(), nodeStamps.end(), 0);
+        searchStamp = 1;
+    }
+
+    // Min-heap on f, ties go to the node closer to the goal.
+    auto worse = [](const OpenNode& a, const OpenNode& b) {
+        return a.f > b.f || (a.f == b.f && a.h > b.h);
+    };
+
+    open.clear();
+    int startH = std::max(0, goalDistance[start] - stopDistance);
+    nodeStamps[start] = searchStamp;
+    nodeParents[start] = -1;
+    open.push_back({startH, startH, start});
+
+    int found = -1;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), worse);
+        OpenNode current = open.back();
+        open.pop_back();
+
+        int time = current.node / cells;
+        int cell = current.node % cells;
+
+        // Steps are all worth 1 so g is the time, the first pop at the
+        // window's end is as good as any later one.
+        if (goalDistance[cell] <= stopDistance || time == window) {
+            found = current.node;
+            break;
+        }
+
+        int x = cell % width;
+        int y = cell / width;
+
+        for (int i = 0; i < 5; i++) {
+            int neighbourX = x + MOVE_X[i];
+            int neighbourY = y + MOVE_Y[i];
+            if (i > 0 && !tileMap->isWalkable(neighbourX, neighbourY)) continue;
+
+            int neighbour = neighbourY * width + neighbourX;
+            if (goalDistance[neighbour] < 0 || !isFree(agent, neighbour, time + 1)) continue;
+
+            // No swapping places with an agent coming the other way.
+            if (neighbour != cell) {
+                size_t ahead = static_cast<size_t>(time) * cells + neighbour;
+                size_t behind = static_cast<size_t>(time + 1) * cells + cell;
+                if (reservedStamps[ahead] == turnStamp && reservedStamps[behind] == turnStamp &&
+                    reservedBy[ahead] == reservedBy[behind] && reservedBy[ahead] != agent) {
+                    continue;
+                }
+            }
+
+            int node = (time + 1) * cells + neighbour;
+            if (nodeStamps[node] == searchStamp) continue;
+
+            nodeStamps[node] = searchStamp;
+            nodeParents[node] = current.node;
+
+            int h = std::max(0, goalDistance[neighbour] - stopDistance);
+            open.push_back({time + 1 + h, h, node});
+            std::push_heap(open.begin(), open.end(), worse);
+        }
+    }
+
+    if (found < 0) {
+        holdPosition(agent, gridX, gridY);
+        return false;
+    }
+
+    plan.clear();
+    for (int node = found; node != -1; node = nodeParents[node]) {
+        plan.push_back(node);
+    }
+    std::reverse(plan.begin(), plan.end());
+
+    for (int node : plan) {
+        reserve(agent, node % cells, node / cells);
+    }
+
+    // Agents that arrive early stay put for the rest of the window.
+    int last = plan.back() % cells;
+    holdPosition(agent, last % width, last / width, plan.back() / cells + 1);
+
+    if (plan.size() < 2 || plan[1] % cells == start) {
+        return false;
+    }
+
+    nextX = (plan[1] % cells) % width;
+    nextY = (plan[1] % cells) / width;
+    return true;
+}
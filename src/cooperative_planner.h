@@ -0,0 +1,77 @@
+#ifndef COOPERATIVE_PLANNER_H
+#define COOPERATIVE_PLANNER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "tilemap.h"
+
+// Windowed cooperative A* (WHCA*) for agents closing in on one goal tile.
+//
+// Agents plan one after another through a space-time reservation table:
+// a planned path reserves (tile, time) for every step of the window, later
+// agents route around those reservations and may not swap tiles with an
+// agent that planned earlier. Plans only look `window` steps ahead and are
+// redone every turn, so only the first step of each is ever executed.
+//
+// The heuristic is the true walking distance to the goal, a BFS from the
+// goal shared by every agent of the turn. Reservations and search nodes live
+// in flat (time * cells + cell) arrays that are validated by stamps instead
+// of being cleared, all buffers are kept between turns.
+class CooperativePlanner {
+public:
+    static const int DEFAULT_WINDOW = 8;
+
+    explicit CooperativePlanner(int window = DEFAULT_WINDOW);
+
+    // Drops the last turn's reservations and measures distances to the goal.
+    // The goal tile itself is reserved for the whole window.
+    void beginTurn(const TileMap* tileMap, int goalX, int goalY);
+
+    // Keeps the agent's tile for itself from `fromTime` to the end of the
+    // window. Reserving every agent's start at time 0 and 1 before planning
+    // stops earlier agents from stepping into a tile that is still occupied.
+    void holdPosition(int agent, int gridX, int gridY, int fromTime = 0);
+    void reserveStart(int agent, int gridX, int gridY);
+
+    // Plans the agent towards any tile within stopDistance steps of the goal
+    // and reserves the plan. Returns false when nothing better than waiting
+    // was found, the agent then holds its tile.
+    bool planStep(int agent, int gridX, int gridY, int stopDistance, int& nextX, int& nextY);
+
+    // Walking distance to the goal, -1 when unreachable.
+    int getGoalDistance(int gridX, int gridY) const;
+
+private:
+    struct OpenNode {
+        int f;
+        int h;
+        int node;
+    };
+
+    const TileMap* tileMap;
+    int window;
+    int width, height;
+    int cells;
+
+    std::vector<int> goalDistance;
+    std::vector<int> bfsQueue;
+
+    // Reservations, valid when the stamp matches the current turn.
+    std::vector<uint32_t> reservedStamps;
+    std::vector<int> reservedBy;
+    uint32_t turnStamp;
+
+    // Search nodes, valid when the stamp matches the current search.
+    std::vector<uint32_t> nodeStamps;
+    std::vector<int> nodeParents;
+    uint32_t searchStamp;
+    std::vector<OpenNode> open;
+    std::vector<int> plan;
+
+    void computeGoalDistances(int goalX, int goalY);
+    void reserve(int agent, int cell, int time);
+    bool isFree(int agent, int cell, int time) const;
+};
+
+#endif // COOPERATIVE_PLANNER_H
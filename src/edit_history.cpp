@@ -0,0 +1,180 @@
+#include "edit_history.h"
+
+namespace {
+
+const size_t DEFAULT_HISTORY_LIMIT = 8 * 1024 * 1024;
+
+}
+
+EditHistory::EditHistory() : recording(false), memoryLimit(DEFAULT_HISTORY_LIMIT), memoryUsage(0) {
+    textures.push_back("");
+    textureLookup[""] = 0;
+}
+
+void EditHistory::begin() {
+    if (recording) {
+        commit();
+    }
+
+    recording = true;
+    current = Transaction();
+    currentLookup.clear();
+}
+
+void EditHistory::record(int tileIndex, EditLayer layer, uint16_t before, uint16_t after) {
+    if (!recording) return;
+
+    uint32_t key = (static_cast<uint32_t>(tileIndex) << 4) | static_cast<uint32_t>(layer);
+
+    // A stroke passing over the same tile again keeps the original value and the newest one.
+    auto it = currentLookup.find(key);
+    if (it != currentLookup.end()) {
+        current.edits[it->second].after = after;
+        return;
+    }
+
+    currentLookup[key] = current.edits.size();
+    current.edits.push_back({key, before, after});
+}
+
+void EditHistory::recordChunk(int x, int y, MapChunk before, MapChunk after) {
+    if (!recording) return;
+
+    if (!current.edits.empty()) {
+        commit();
+        begin();
+    }
+
+    current.chunks.push_back({x, y, before, after});
+}
+
+void EditHistory::commit() {
+    if (!recording) return;
+    recording = false;
+    currentLookup.clear();
+
+    Transaction transaction;
+    for (const auto& edit : current.edits) {
+        if (edit.before != edit.after) {
+            transaction.edits.push_back(edit);
+        }
+    }
+    transaction.chunks.swap(current.chunks);
+    current = Transaction();
+
+    if (transaction.edits.empty() && transaction.chunks.empty()) return;
+
+    for (const auto& redone : redoStack) {
+        memoryUsage -= transactionBytes(redone);
+    }
+    redoStack.clear();
+
+    transaction.edits.shrink_to_fit();
+    memoryUsage += transactionBytes(transaction);
+    undoStack.push_back(std::move(transaction));
+
+    enforceMemoryLimit();
+}
+
+bool EditHistory::undo(std::vector<TileEdit>& edits, std::vector<ChunkEdit>& chunks) {
+    if (recording) commit();
+    if (undoStack.empty()) return false;
+
+    Transaction transaction = std::move(undoStack.back());
+    undoStack.pop_back();
+
+    // Reverse order so a tile touched twice ends up at its first value.
+    edits.assign(transaction.edits.rbegin(), transaction.edits.rend());
+    for (auto& edit : edits) {
+        edit.after = edit.before;
+    }
+
+    chunks.assign(transaction.chunks.rbegin(), transaction.chunks.rend());
+    for (auto& chunk : chunks) {
+        chunk.after = chunk.before;
+    }
+
+    redoStack.push_back(std::move(transaction));
+    return true;
+}
+
+bool EditHistory::redo(std::vector<TileEdit>& edits, std::vector<ChunkEdit>& chunks) {
+    if (recording) commit();
+    if (redoStack.empty()) return false;
+
+    Transaction transaction = std::move(redoStack.back());
+    redoStack.pop_back();
+
+    edits = transaction.edits;
+    chunks = transaction.chunks;
+    undoStack.push_back(std::move(transaction));
+    return true;
+}
+
+void EditHistory::clear() {
+    undoStack.clear();
+    redoStack.clear();
+    current = Transaction();
+    currentLookup.clear();
+    recording = false;
+    memoryUsage = 0;
+}
+
+void EditHistory::setMemoryLimit(size_t bytes) {
+    memoryLimit = bytes;
+    enforceMemoryLimit();
+}
+
+uint16_t EditHistory::internTexture(const std::string& textureID) {
+    auto it = textureLookup.find(textureID);
+    if (it != textureLookup.end()) {
+        return it->second;
+    }
+
+    uint16_t index = static_cast<uint16_t>(textures.size());
+    textures.push_back(textureID);
+    textureLookup[textureID] = index;
+    return index;
+}
+
+const std::string& EditHistory::getTexture(uint16_t index) const {
+    return index < textures.size() ? textures[index] : textures[0];
+}
+
+size_t EditHistory::transactionBytes(const Transaction& transaction) {
+    size_t bytes = sizeof(Transaction) + transaction.edits.capacity() * sizeof(TileEdit);
+
+    // The placed chunk is shared with the stamp or clipboard it came from,
+    // only the overwritten tiles belong to the history.
+    for (const auto& chunk : transaction.chunks) {
+        bytes += sizeof(ChunkEdit);
+        if (chunk.before) {
+            bytes += chunkBytes(*chunk.before);
+        }
+    }
+    return bytes;
+}
+
+size_t EditHistory::chunkBytes(const MapData& chunk) {
+    size_t bytes = sizeof(MapData) + chunk.ground.capacity() * sizeof(uint16_t) +
+                   chunk.objects.capacity() * sizeof(uint16_t) + chunk.walkable.capacity();
+    for (const auto& layer : chunk.decorations) {
+        bytes += sizeof(MapDataLayer) + layer.name.capacity() + layer.tiles.capacity() * sizeof(uint16_t);
+    }
+    for (const auto& textureID : chunk.palette) {
+        bytes += sizeof(std::string) + textureID.capacity();
+    }
+    return bytes;
+}
+
+void EditHistory::enforceMemoryLimit() {
+    // Redo entries go first since they are the least likely to be used, then the oldest undo steps.
+    while (memoryUsage > memoryLimit && !redoStack.empty()) {
+        memoryUsage -= transactionBytes(redoStack.front());
+        redoStack.pop_front();
+    }
+    while (memoryUsage > memoryLimit && undoStack.size() > 1) {
+        memoryUsage -= transactionBytes(undoStack.front());
+        undoStack.pop_front();
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef EDIT_HISTORY_H
+#define EDIT_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include "map_data.h"
+
+// Decoration layers follow WALKABLE, DECORATION + n is the map's n-th
+// decoration layer. Four bits are kept for the layer.
+enum class EditLayer : uint8_t {
+    GROUND,
+    OBJECTS,
+    WALKABLE,
+    DECORATION
+};
+
+inline EditLayer getDecorationEditLayer(int index) {
+    return static_cast<EditLayer>(static_cast<int>(EditLayer::DECORATION) + index);
+}
+
+inline int getDecorationIndex(EditLayer layer) {
+    return static_cast<int>(layer) - static_cast<int>(EditLayer::DECORATION);
+}
+
+// One changed tile layer in 8 bytes: the tile index and layer packed into a
+// uint32, and the values before and after as uint16. Texture layers store
+// indices into the history's texture table, WALKABLE stores 0 or 1.
+struct TileEdit {
+    uint32_t key;
+    uint16_t before;
+    uint16_t after;
+
+    int getTileIndex() const { return static_cast<int>(key >> 4); }
+    EditLayer getLayer() const { return static_cast<EditLayer>(key & 15); }
+};
+
+// Immutable block of tiles. Stamps, the clipboard and paste history share
+// one copy, nothing writes to a chunk once it has been handed out.
+typedef std::shared_ptr<const MapData> MapChunk;
+
+// A rectangular block written in one go at (x, y).
+struct ChunkEdit {
+    int x;
+    int y;
+    MapChunk before;
+    MapChunk after;
+};
+
+// Undo/redo history made of transactions. Everything recorded between
+// begin() and commit() (a pencil stroke, a fill) is undone in one step, and
+// touching the same tile twice in a transaction keeps a single edit. The
+// oldest transactions are dropped once the history passes its memory limit.
+class EditHistory {
+public:
+    EditHistory();
+
+    void begin();
+    void record(int tileIndex, EditLayer layer, uint16_t before, uint16_t after);
+    // Only the chunk being placed is referenced, not copied. Chunks come
+    // before any tile edit of a transaction, a chunk recorded after tile
+    // edits commits them and starts a new transaction.
+    void recordChunk(int x, int y, MapChunk before, MapChunk after);
+    void commit();
+    bool isRecording() const { return recording; }
+
+    // Hand back a whole transaction, each tile edit sets its layer to
+    // edit.after and each chunk edit writes chunk.after. Undo applies the tile
+    // edits before the chunks, redo the chunks before the tile edits.
+    bool undo(std::vector<TileEdit>& edits, std::vector<ChunkEdit>& chunks);
+    bool redo(std::vector<TileEdit>& edits, std::vector<ChunkEdit>& chunks);
+
+    bool canUndo() const { return !undoStack.empty(); }
+    bool canRedo() const { return !redoStack.empty(); }
+    void clear();
+
+    void setMemoryLimit(size_t bytes);
+    size_t getMemoryLimit() const { return memoryLimit; }
+    size_t getMemoryUsage() const { return memoryUsage; }
+
+    uint16_t internTexture(const std::string& textureID);
+    const std::string& getTexture(uint16_t index) const;
+
+private:
+    struct Transaction {
+        std::vector<TileEdit> edits;
+        std::vector<ChunkEdit> chunks;
+    };
+
+    std::deque<Transaction> undoStack;
+    std::deque<Transaction> redoStack;
+
+    Transaction current;
+    std::unordered_map<uint32_t, size_t> currentLookup;
+    bool recording;
+
+    // Texture ids are shared by all transactions and only grow, they are tiny next to the edits.
+    std::vector<std::string> textures;
+    std::unordered_map<std::string, uint16_t> textureLookup;
+
+    size_t memoryLimit;
+    size_t memoryUsage;
+
+    static size_t transactionBytes(const Transaction& transaction);
+    static size_t chunkBytes(const MapData& chunk);
+    void enforceMemoryLimit();
+};
+
+#endif // EDIT_HISTORY_H
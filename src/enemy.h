@@ -18,9 +18,12 @@ public:
     int getHealth() const { return health; }
     bool isDead() const { return health <= 0; }
     int getDamage() const { return damage; }
+    int getAttackRange() const { return attackRange; }
 
     void setTargetPosition(float targetX, float targetY);
     bool isCurrentlyMoving() const { return hasTarget; }
+    float getTargetX() const { return targetX; }
+    float getTargetY() const { return targetY; }
 
     void calculateAttackTargets(const TileMap* tileMap, Player* player);
     bool canAttackPlayer() const { return inAttackRange; }
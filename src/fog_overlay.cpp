@@ -0,0 +1,91 @@
+#include "fog_overlay.h"
+#include <iostream>
+
+namespace {
+
+const Uint32 FOG_UNEXPLORED = 0xFF000000u;
+const Uint32 FOG_REMEMBERED = 0xA0000000u;
+const Uint32 FOG_VISIBLE = 0x00000000u;
+
+}
+
+FogOverlay::FogOverlay() : texture(nullptr), width(0), height(0), tileSize(0), source(nullptr) {
+}
+
+FogOverlay::~FogOverlay() {
+    destroy();
+}
+
+void FogOverlay::destroy() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    width = 0;
+    height = 0;
+    source = nullptr;
+}
+
+void FogOverlay::update(Renderer& renderer, TileMap* tileMap) {
+    if (!tileMap || !renderer.getRenderer()) return;
+
+    SDL_Rect dirty;
+    bool hasDirty = tileMap->getVisibility().takeDirtyRect(dirty);
+
+    bool resized = width != tileMap->getGridWidth() || height != tileMap->getGridHeight();
+    if (!texture || resized) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+        }
+
+        width = tileMap->getGridWidth();
+        height = tileMap->getGridHeight();
+        texture = SDL_CreateTexture(renderer.getRenderer(), SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!texture) {
+            std::cerr << "Failed to create fog texture: " << SDL_GetError() << std::endl;
+            width = 0;
+            height = 0;
+            return;
+        }
+
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    }
+
+    tileSize = tileMap->getTileSize();
+
+    if (tileMap != source || resized) {
+        source = tileMap;
+        uploadRect({0, 0, width, height});
+    } else if (hasDirty) {
+        uploadRect(dirty);
+    }
+}
+
+void FogOverlay::uploadRect(const SDL_Rect& rect) {
+    const VisibilityField& visibility = source->getVisibility();
+    texels.resize(static_cast<size_t>(rect.w) * rect.h);
+
+    for (int y = 0; y < rect.h; y++) {
+        for (int x = 0; x < rect.w; x++) {
+            Uint32 texel = FOG_UNEXPLORED;
+            if (visibility.isVisible(rect.x + x, rect.y + y)) {
+                texel = FOG_VISIBLE;
+            } else if (visibility.isExplored(rect.x + x, rect.y + y)) {
+                texel = FOG_REMEMBERED;
+            }
+
+            texels[static_cast<size_t>(y) * rect.w + x] = texel;
+        }
+    }
+
+    SDL_UpdateTexture(texture, &rect, texels.data(), rect.w * sizeof(Uint32));
+}
+
+void FogOverlay::render(Renderer& renderer) {
+    if (!texture || !source) return;
+
+    SDL_Rect destRect = {-renderer.getViewOffsetX(), -renderer.getViewOffsetY(), width * tileSize, height * tileSize};
+    SDL_RenderCopy(renderer.getRenderer(), texture, nullptr, &destRect);
+}
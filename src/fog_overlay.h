@@ -0,0 +1,34 @@
+#ifndef FOG_OVERLAY_H
+#define FOG_OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "renderer.h"
+#include "tilemap.h"
+
+// Draws a TileMap's visibility field as fog of war: one texel per tile in a
+// streaming texture stretched over the map. Unexplored tiles are black,
+// explored tiles out of sight are dimmed. Only the field's dirty rect is
+// re-uploaded, so a unit moving costs the same on any map size.
+class FogOverlay {
+public:
+    FogOverlay();
+    ~FogOverlay();
+
+    void update(Renderer& renderer, TileMap* tileMap);
+    void render(Renderer& renderer);
+
+    void destroy();
+
+private:
+    SDL_Texture* texture;
+    int width, height;
+    int tileSize;
+    TileMap* source;
+
+    std::vector<Uint32> texels;
+
+    void uploadRect(const SDL_Rect& rect);
+};
+
+#endif // FOG_OVERLAY_H
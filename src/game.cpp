@@ -2,28 +2,62 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <set>
 
 Game::Game() : currentState(GameState::CITY), isRunning(true), mouseX(0), mouseY(0),
                score(0), movesRemaining(10), playerSelected(false),
                window(nullptr), glContext(nullptr), imguiInitialized(false),
-               inCombat(false) {
+               inCombat(false), renderer(nullptr), showTextureStats(false) {
 
     uiManagerCity = new UIManager(1024, 768);
     uiManagerArena = new UIManager(1024, 768);
 
-    tileMap = new TileMap(32, 1024, 768);
-    mapEditor = new MapEditor(tileMap);
+    // Each scene keeps its own resident map, tileMap points at the active one.
+    cityMap = new TileMap(32, 1024, 768);
+    arenaMap = new TileMap(32, 1024, 768);
+    editorMap = new TileMap(32, 1024, 768);
+    playtestMap = new TileMap(32, 1024, 768);
+    tileMap = cityMap;
+
+    mapEditor = new MapEditor(editorMap);
 
     uiEditor = new UIEditor(uiManagerCity, uiManagerArena);
 
     player = new Player(100, 100);
 
-    combatManager = new CombatManager(player, tileMap);
+    combatManager = new CombatManager(player, arenaMap);
+
+    hotReloader = new HotReloader();
+
+    mapCache = new MapCache();
+    mapEditor->setMapCache(mapCache);
+
+    minimap = new Minimap();
+
+    movementOverlay = new TileOverlay("tile_selection", {80, 160, 255, 110});
+    attackOverlay = new TileOverlay("tile_selection_enemy", {255, 70, 70, 110});
+    // No texture ships for this one, the fallback colour is kept.
+    threatenedMoveOverlay = new TileOverlay("tile_selection_threat", {255, 170, 40, 130});
+    threatOverlay = new ThreatOverlay();
+
+    fogOverlay = new FogOverlay();
+    playerViewer = -1;
 }
 
 Game::~Game() {
+    delete hotReloader;
+    delete mapCache;
+    delete minimap;
+    delete movementOverlay;
+    delete attackOverlay;
+    delete threatenedMoveOverlay;
+    delete threatOverlay;
+    delete fogOverlay;
     delete player;
-    delete tileMap;
+    delete cityMap;
+    delete arenaMap;
+    delete editorMap;
+    delete playtestMap;
     delete mapEditor;
     delete combatManager;
     delete uiEditor;
@@ -39,14 +73,19 @@ Game::~Game() {
 }
 
 bool Game::initialize() {
-    tileMap->initialize();
+    cityMap->initialize();
+    arenaMap->initialize();
+    editorMap->initialize();
+    playtestMap->initialize();
 
     currentCity = "default";
     currentArena = "arena";
 
     std::filesystem::create_directories("maps");
 
-    bool cityLoaded = loadMap(currentCity);
+    mapCache->start();
+
+    bool cityLoaded = loadMap(currentCity, cityMap, cityData);
     if (!cityLoaded) {
         std::cout << "No city map found. Use the editor to create one." << std::endl;
 
@@ -54,10 +93,12 @@ bool Game::initialize() {
         mapEditor->saveMap("maps/default.json");
         mapEditor->saveMap("maps/arena.json");
 
-        loadMap(currentCity);
+        loadMap(currentCity, cityMap, cityData);
     }
 
     placePlayerInValidPosition();
+
+    mapCache->prefetch(currentArena);
     return true;
 }
 
@@ -99,74 +140,72 @@ void Game::placePlayerInValidPosition() {
     std::cout << "Warning: No walkable tiles found for player placement." << std::endl;
 }
 
-bool Game::loadAssets(Renderer& renderer) {
-    if (!renderer.loadTexture("player", "assets/player.png")) {
-        std::cout << "Warning: Player sprite not found. Using placeholder." << std::endl;
+void Game::placePlayerAt(int gridX, int gridY) {
+    if (!tileMap->isWalkable(gridX, gridY)) {
+        placePlayerInValidPosition();
+        return;
     }
 
-    if (!renderer.loadTexture("tile_grass", "assets/tile_grass.png")){
-        std::cout << "Warning: Tile Grass sprite not found. Using placeholder." << std::endl;
-    }
+    int pixelX, pixelY;
+    tileMap->gridToPixel(gridX, gridY, pixelX, pixelY);
 
-    if (!renderer.loadTexture("tile_wall", "assets/tile_wall.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    player->setX(pixelX + tileMap->getTileSize() / 2 - player->getCollider().w / 2);
+    player->setY(pixelY + tileMap->getTileSize() / 2 - player->getCollider().h / 2);
+}
 
-    if (!renderer.loadTexture("base_limit", "assets/base_limit.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+bool Game::loadAssets(Renderer& renderer) {
+    this->renderer = &renderer;
 
-    if (!renderer.loadTexture("border_grass", "assets/border_grass.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    // The packed archive is optional, without it textures are decoded from assets/.
+    renderer.openArchive("assets/assets.pak");
 
-    if (!renderer.loadTexture("border1", "assets/border1.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
+    if (!renderer.loadManifest("assets/manifest.json")) {
+        std::cout << "Warning: Asset manifest not found. Textures will use placeholders." << std::endl;
     }
 
-    if (!renderer.loadTexture("border2", "assets/border2.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
+    if (renderer.getManifest().getTextureBudgetMB() > 0) {
+        renderer.setTextureBudget(static_cast<size_t>(renderer.getManifest().getTextureBudgetMB()) * 1024 * 1024);
     }
 
-    if (!renderer.loadTexture("border_path", "assets/border_path.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    // Only the starting scene is loaded up front, everything else loads on first use.
+    updateSceneTextures(currentState == GameState::EDITOR ? "editor" : "city");
 
-    if (!renderer.loadTexture("border_water", "assets/border_water.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
+    while (renderer.isLoadingTextures()) {
+        SDL_PumpEvents();
+        renderer.processLoadedTextures();
+        renderLoadingScreen(renderer, renderer.getLoadProgress());
+        SDL_Delay(1);
     }
+    renderer.processLoadedTextures();
 
-    if (!renderer.loadTexture("enemy", "assets/enemy.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    initializeUI();
 
-    if (!renderer.loadTexture("player_selection", "assets/player_selection.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    hotReloader->start({"assets", "maps", "layouts"});
 
-    if (!renderer.loadTexture("tile_selection", "assets/tile_selection.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+    return true;
+}
 
-    if (!renderer.loadTexture("tile_selection_enemy", "assets/tile_selection_enemy.png")){
-        std::cout << "Warning: Tile Wall sprite not found. Using placeholder." << std::endl;
-    }
+void Game::renderLoadingScreen(Renderer& renderer, float progress) {
+    const int barWidth = 400;
+    const int barHeight = 24;
+    const int barX = (1024 - barWidth) / 2;
+    const int barY = (768 - barHeight) / 2;
 
-    if (!renderer.loadTexture("ui_menu_background", "assets/ui_menu_background.png")){
-        std::cout << "Warning: UI Menu Background sprite not found. Using placeholder." << std::endl;
-    }
+    renderer.clear();
 
-    if (!renderer.loadTexture("btn_arena", "assets/arena_button_normal.png")){
-        std::cout << "Warning: UI Menu Background sprite not found. Using placeholder." << std::endl;
-    }
+    renderer.setDrawColor(60, 60, 60, 255);
+    renderer.fillRect(barX, barY, barWidth, barHeight);
 
-    if (!renderer.loadTexture("btn_arena_hover", "assets/arena_button_normal.png")){
-        std::cout << "Warning: UI Menu Background sprite not found. Using placeholder." << std::endl;
-    }
+    renderer.setDrawColor(80, 180, 80, 255);
+    renderer.fillRect(barX, barY, static_cast<int>(barWidth * progress), barHeight);
 
-    initializeUI();
+    renderer.setDrawColor(255, 255, 255, 255);
+    renderer.drawRect(barX, barY, barWidth, barHeight);
 
-    return true;
+    std::string loadingText = "Loading assets... " + std::to_string(static_cast<int>(progress * 100)) + "%";
+    renderer.drawText(loadingText, barX, barY - 24);
+
+    renderer.present();
 }
 
 // In Game::initializeUI() method, modify the beginning:
@@ -246,14 +285,34 @@ void Game::initializeUI() {
 }
 
 void Game::handleEvent(SDL_Event& e) {
-    if (e.type == SDL_MOUSEMOTION) {
+    // Gameplay works in world pixels, the map view may be scrolled.
+    if (e.type == SDL_MOUSEMOTION || e.type == SDL_MOUSEBUTTONDOWN) {
         SDL_GetMouseState(&mouseX, &mouseY);
+        mouseX += tileMap->getViewX();
+        mouseY += tileMap->getViewY();
+    }
+
+    // Cached layer chunks are render targets, their contents are gone after a reset.
+    if (e.type == SDL_RENDER_TARGETS_RESET) {
+        for (TileMap* map : {cityMap, arenaMap, editorMap, playtestMap}) {
+            map->invalidateRenderCache();
+        }
     }
 
     if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_u) {
         toggleUIEditor();
     }
 
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+        showTextureStats = !showTextureStats;
+    }
+
+    if (currentState == GameState::PLAYTEST && e.type == SDL_KEYDOWN &&
+        (e.key.keysym.sym == SDLK_ESCAPE || e.key.keysym.sym == SDLK_F5 || e.key.keysym.sym == SDLK_m)) {
+        stopPlaytest();
+        return;
+    }
+
     if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_m) {
         if (currentState == GameState::EDITOR) {
             switchToCity();
@@ -267,6 +326,10 @@ void Game::handleEvent(SDL_Event& e) {
         return;
     }
 
+    if (currentState != GameState::EDITOR && minimap->handleEvent(e)) {
+        return;
+    }
+
     bool uiHandled = false;
     switch (currentState) {
         case GameState::CITY:
@@ -290,6 +353,9 @@ void Game::handleEvent(SDL_Event& e) {
             case GameState::EDITOR:
                 handleEditorEvents(e);
                 break;
+            case GameState::PLAYTEST:
+                handleCityEvents(e);
+                break;
         }
     }
 }
@@ -389,6 +455,8 @@ void Game::handleEditorEvents(SDL_Event& e) {
 }
 
 void Game::update() {
+    processHotReloads();
+
     player->update();
 
     for (auto entity : entities) {
@@ -409,6 +477,8 @@ void Game::update() {
         case GameState::EDITOR:
             updateEditor();
             break;
+        case GameState::PLAYTEST:
+            break;
     }
 }
 
@@ -422,6 +492,7 @@ void Game::updateCity() {
 
 void Game::updateArena() {
     player->update();
+    updatePlayerViewer();
 
     if (inCombat) {
         combatManager->update();
@@ -439,9 +510,17 @@ void Game::updateArena() {
 
 void Game::updateEditor() {
     mapEditor->update();
+
+    int startX, startY;
+    if (mapEditor->popPlayRequest(startX, startY)) {
+        startPlaytest(startX, startY);
+    }
 }
 
 void Game::render(Renderer& renderer) {
+    // World drawing follows the map view, UI is drawn in screen space.
+    renderer.setViewOffset(tileMap->getViewX(), tileMap->getViewY());
+
     switch (currentState) {
         case GameState::CITY:
             tileMap->render(renderer);
@@ -450,58 +529,84 @@ void Game::render(Renderer& renderer) {
                 entity->render(renderer);
             }
             player->render(renderer);
+            renderer.setViewOffset(0, 0);
             uiManagerCity->render(renderer);
+            renderMinimap(renderer);
             break;
         case GameState::ARENA:
             tileMap->render(renderer);
+            if (inCombat) {
+                threatOverlay->update(renderer, combatManager->getThreatField(), tileMap);
+                threatOverlay->render(renderer);
+            }
             renderArena(renderer);
             renderMovementRange(renderer);
             for (auto entity : entities) {
                 entity->render(renderer);
             }
             player->render(renderer);
+            fogOverlay->update(renderer, tileMap);
+            fogOverlay->render(renderer);
+            renderer.setViewOffset(0, 0);
             uiManagerArena->render(renderer);
+            renderMinimap(renderer);
             break;
         case GameState::EDITOR:
             renderEditor(renderer);
             break;
+        case GameState::PLAYTEST:
+            tileMap->render(renderer);
+            renderMovementRange(renderer);
+            player->render(renderer);
+            renderer.setViewOffset(0, 0);
+            renderer.drawText("Playtest - Esc returns to the editor", 10, 10);
+            renderMinimap(renderer);
+            break;
     }
 
+    renderer.setViewOffset(0, 0);
+
     if (uiEditor->isActive()) {
         uiEditor->render(renderer);
     }
-}
 
-void Game::renderCity(Renderer& renderer) {
+    if (showTextureStats) {
+        renderTextureStatsPanel(renderer);
+    }
 }
 
-void Game::renderArena(Renderer& renderer) {
-    if (playerSelected) {
-        const auto& availableTiles = player->getAvailableTiles();
-        for (const auto& tile : availableTiles) {
-            int pixelX, pixelY;
-            tileMap->gridToPixel(tile.first, tile.second, pixelX, pixelY);
+void Game::renderTextureStatsPanel(Renderer& renderer) {
+    ImGui::SetNextWindowPos(ImVec2(760, 30), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(250, 160), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Texture Residency (F3)", &showTextureStats)) {
+        TextureStats stats = renderer.getTextureStats();
+        const float megabyte = 1024.0f * 1024.0f;
+
+        ImGui::Text("Resident: %d textures", stats.residentCount);
+        ImGui::Text("Memory: %.2f / %.2f MB", stats.residentBytes / megabyte, stats.budgetBytes / megabyte);
+        ImGui::ProgressBar(stats.budgetBytes > 0 ? static_cast<float>(stats.residentBytes) / stats.budgetBytes : 0.0f);
+        ImGui::Text("Pending: %d", stats.pendingCount);
+        ImGui::Text("Evictions: %d | Reloads: %d", stats.evictionCount, stats.reloadCount);
 
-            renderer.renderTexture("tile_selection", pixelX, pixelY,
-                                 tileMap->getTileSize(), tileMap->getTileSize());
+        int budgetMB = static_cast<int>(stats.budgetBytes / (1024 * 1024));
+        if (ImGui::SliderInt("Budget (MB)", &budgetMB, 1, 512)) {
+            renderer.setTextureBudget(static_cast<size_t>(budgetMB) * 1024 * 1024);
         }
     }
+    ImGui::End();
+}
+
+void Game::renderCity(Renderer& renderer) {
+}
 
+void Game::renderArena(Renderer& renderer) {
+    // Movement tiles are drawn by renderMovementRange, attack targets get their own overlay.
     if (playerSelected) {
-        const auto& attackTargets = player->getAttackTargets();
-        for (const auto& tile : attackTargets) {
-            int pixelX, pixelY;
-            tileMap->gridToPixel(tile.first, tile.second, pixelX, pixelY);
-
-            int enemyIndex = combatManager->getEnemyAt(tile.first, tile.second);
-            if (inCombat && enemyIndex != -1) {
-                renderer.renderTexture("tile_selection_enemy", pixelX, pixelY,
-                                     tileMap->getTileSize(), tileMap->getTileSize());
-            } else {
-                renderer.renderTexture("tile_selection_enemy", pixelX, pixelY,
-                                     tileMap->getTileSize(), tileMap->getTileSize());
-            }
-        }
+        attackOverlay->setTiles(renderer, tileMap, player->getAttackTargets());
+        attackOverlay->render(renderer);
+    } else {
+        attackOverlay->clear();
     }
 
     if (inCombat) {
@@ -515,18 +620,36 @@ void Game::renderArena(Renderer& renderer) {
     }
 }
 
+void Game::renderMinimap(Renderer& renderer) {
+    const int scale = 3;
+
+    minimap->update(renderer, tileMap);
+    minimap->render(renderer, 1024 - minimap->getWidth() * scale - 10, 10, scale);
+}
+
 void Game::renderEditor(Renderer& renderer) {
+    renderer.setViewOffset(0, 0);
     renderer.setDrawColor(100, 100, 100, 255);
     renderer.fillRect(0, 0, 1024, 768);
+    renderer.setViewOffset(tileMap->getViewX(), tileMap->getViewY());
 
     tileMap->render(renderer);
     mapEditor->render(renderer);
 }
 
+void Game::setActiveMap(TileMap* map) {
+    // Only the map on screen keeps its layer caches in video memory.
+    if (tileMap != map) {
+        tileMap->releaseRenderCache();
+    }
+    tileMap = map;
+}
+
 void Game::switchToCity() {
     currentState = GameState::CITY;
     mapEditor->setActive(false);
-    loadMap(currentCity);
+    loadMap(currentCity, cityMap, cityData);
+    setActiveMap(cityMap);
     placePlayerInValidPosition();
 
     if (inCombat) {
@@ -534,26 +657,50 @@ void Game::switchToCity() {
         inCombat = false;
     }
 
+    updateSceneTextures("city");
+
+    // The arena is the only way out of the city, have it parsed before the button is hit.
+    mapCache->prefetch(currentArena);
+
     std::cout << "Switched to city: " << currentCity << std::endl;
 }
 
 void Game::switchToArena() {
     currentState = GameState::ARENA;
     mapEditor->setActive(false);
-    loadMap(currentArena);
+    loadMap(currentArena, arenaMap, arenaData);
+    setActiveMap(arenaMap);
     placePlayerInValidPosition();
 
+    // Every fight starts unexplored.
+    tileMap->clearVisibility();
+    updatePlayerViewer();
+
     player->setRemainingAttacks(player->getMaxAttacks());
 
     combatManager->startCombat(1);
     inCombat = true;
 
+    updateSceneTextures("arena");
+
+    mapCache->prefetch(currentCity);
+
     std::cout << "Switched to arena: " << currentArena << std::endl;
 }
 
 void Game::switchToEditor() {
+    // The editor starts from the scene that was on screen, after that it keeps its own scratch map.
+    if (mapEditor->getLoadedMapPath().empty()) {
+        const std::shared_ptr<const MapData>& sceneData = currentState == GameState::ARENA ? arenaData : cityData;
+        const std::string& sceneName = currentState == GameState::ARENA ? currentArena : currentCity;
+        if (sceneData) {
+            mapEditor->applyMapData(*sceneData, MapCache::getMapPath(sceneName));
+        }
+    }
+
     currentState = GameState::EDITOR;
     mapEditor->setActive(true);
+    setActiveMap(editorMap);
 
     std::ifstream mapCheck("map.json");
     if (!mapCheck.good()) {
@@ -562,48 +709,226 @@ void Game::switchToEditor() {
     }
     mapCheck.close();
 
+    updateSceneTextures("editor");
+
     std::cout << "Switched to editor" << std::endl;
 }
 
+void Game::startPlaytest(int startX, int startY) {
+    // The session runs on its own copy so nothing in the game can change the
+    // editor's map or history, and the editor map is never written to disk.
+    MapData snapshot;
+    editorMap->toMapData(snapshot);
+    playtestMap->applyMapData(snapshot);
+
+    currentState = GameState::PLAYTEST;
+    mapEditor->setActive(false);
+    setActiveMap(playtestMap);
+
+    player->setSelected(false);
+    playerSelected = false;
+    if (startX >= 0 && startY >= 0) {
+        placePlayerAt(startX, startY);
+    } else {
+        placePlayerInValidPosition();
+    }
+
+    updateSceneTextures("city");
+
+    std::cout << "Started playtest" << std::endl;
+}
+
+void Game::stopPlaytest() {
+    currentState = GameState::EDITOR;
+    mapEditor->setActive(true);
+    setActiveMap(editorMap);
+
+    player->setSelected(false);
+    playerSelected = false;
+
+    updateSceneTextures("editor");
+
+    std::cout << "Returned to editor" << std::endl;
+}
+
 void Game::cleanup() {
+    hotReloader->stop();
+    mapCache->shutdown();
+    minimap->destroy();
+    movementOverlay->destroy();
+    attackOverlay->destroy();
+    threatenedMoveOverlay->destroy();
+    threatOverlay->destroy();
+    fogOverlay->destroy();
+    mapEditor->releaseTextures();
+    for (TileMap* map : {cityMap, arenaMap, editorMap, playtestMap}) {
+        map->releaseRenderCache();
+    }
     shutdownImGui();
     // Cleanup I guesss.
 }
 
 void Game::renderMovementRange(Renderer& renderer) {
-    if (!playerSelected) return;
+    if (!playerSelected) {
+        movementOverlay->clear();
+        threatenedMoveOverlay->clear();
+        return;
+    }
+
+    if (!(currentState == GameState::ARENA && inCombat)) {
+        threatenedMoveOverlay->clear();
+        movementOverlay->setTiles(renderer, tileMap, player->getAvailableTiles());
+        movementOverlay->render(renderer);
+        return;
+    }
 
-    const auto& availableTiles = player->getAvailableTiles();
-    for (const auto& tile : availableTiles) {
-        int pixelX, pixelY;
-        tileMap->gridToPixel(tile.first, tile.second, pixelX, pixelY);
+    // Like the threat overlay, tiles out of sight don't give away hidden enemies.
+    const VisibilityField& visibility = tileMap->getVisibility();
+    std::vector<std::pair<int, int>> safeTiles;
+    std::vector<std::pair<int, int>> threatenedTiles;
+    for (const auto& tile : player->getAvailableTiles()) {
+        bool seen = !visibility.hasViewers() || visibility.isVisible(tile.first, tile.second);
+        if (seen && combatManager->getThreatAt(tile.first, tile.second) > 0) {
+            threatenedTiles.push_back(tile);
+        } else {
+            safeTiles.push_back(tile);
+        }
+    }
 
-        renderer.renderTexture("tile_selection", pixelX, pixelY, tileMap->getTileSize(), tileMap->getTileSize());
+    movementOverlay->setTiles(renderer, tileMap, safeTiles);
+    movementOverlay->render(renderer);
+    threatenedMoveOverlay->setTiles(renderer, tileMap, threatenedTiles);
+    threatenedMoveOverlay->render(renderer);
+}
+
+void Game::updatePlayerViewer() {
+    SDL_Rect collider = player->getCollider();
+    int gridX, gridY;
+    tileMap->pixelToGrid(collider.x + collider.w / 2, collider.y + collider.h / 2, gridX, gridY);
+
+    // Loading map data drops the viewers, e.g. when the arena is hot reloaded.
+    if (!tileMap->getVisibility().hasViewers()) {
+        playerViewer = tileMap->addViewer(gridX, gridY, PLAYER_SIGHT_RADIUS);
+    } else {
+        tileMap->moveViewer(playerViewer, gridX, gridY);
     }
 }
 
-bool Game::loadMap(const std::string& mapName) {
-    std::string mapPath = "maps/" + mapName + ".json";
-    if (!mapEditor->loadMap(mapPath)) {
-        std::cerr << "Failed to load map: " << mapPath << std::endl;
+void Game::updateSceneTextures(const std::string& scene) {
+    if (!renderer) return;
+
+    const AssetManifest& manifest = renderer->getManifest();
+
+    std::set<std::string> textures;
+    for (const auto& id : manifest.getSceneTextures("common")) {
+        textures.insert(id);
+    }
+    for (const auto& id : manifest.getSceneTextures(scene)) {
+        textures.insert(id);
+    }
+
+    // Collect palette indices first, every texture layer is scanned once.
+    std::vector<bool> used;
+    for (auto layer : tileMap->getLayers()) {
+        if (layer->getKind() == TileLayerKind::COLLISION) continue;
+
+        for (uint16_t value : layer->getCells()) {
+            if (value >= used.size()) used.resize(value + 1, false);
+            used[value] = true;
+        }
+    }
+    for (size_t i = 1; i < used.size(); i++) {
+        if (used[i]) {
+            textures.insert(tileMap->getTexture(static_cast<uint16_t>(i)));
+        }
+    }
+
+    // Acquire before releasing so textures shared by both scenes stay resident.
+    for (const auto& id : textures) {
+        renderer->acquireTexture(id);
+    }
+    for (const auto& id : sceneTextures) {
+        renderer->releaseTexture(id);
+    }
+
+    sceneTextures = textures;
+    renderer->releaseUnreferencedTextures();
+}
+
+void Game::processHotReloads() {
+    HotReloadEvent event;
+
+    while (hotReloader->popEvent(event)) {
+        switch (event.type) {
+            case HotReloadType::TEXTURE:
+                if (renderer) {
+                    for (const auto& entry : renderer->getManifest().getTextures()) {
+                        if (entry.second == event.path) {
+                            renderer->reloadTexture(entry.first);
+                        }
+                    }
+                }
+                break;
+            case HotReloadType::MANIFEST:
+                if (renderer) {
+                    renderer->loadManifest(event.path);
+                }
+                break;
+            case HotReloadType::MAP: {
+                // The editor's own saves already stored their snapshot in the cache. Applying
+                // the file to the editor would roll back edits made since and drop unsaved
+                // decoration changes.
+                bool ownSave = mapEditor->isOwnSave(event.path, event.writeTime);
+                if (!ownSave) {
+                    mapCache->store(MapCache::getMapName(event.path), event.map);
+                }
+
+                // Resident maps are refreshed in place, others pick up the cached copy when loaded.
+                if (MapCache::getMapName(event.path) == currentCity && cityData) {
+                    loadMap(currentCity, cityMap, cityData);
+                }
+                if (MapCache::getMapName(event.path) == currentArena && arenaData) {
+                    loadMap(currentArena, arenaMap, arenaData);
+                }
+                if (!ownSave && event.path == mapEditor->getLoadedMapPath()) {
+                    mapEditor->applyMapData(*event.map, event.path);
+                }
+
+                updateSceneTextures(currentState == GameState::CITY || currentState == GameState::PLAYTEST ? "city" :
+                                    currentState == GameState::ARENA ? "arena" : "editor");
+                break;
+            }
+            case HotReloadType::LAYOUT:
+                uiEditor->applyLayout(*event.layout, event.path);
+                break;
+        }
+    }
+}
+
+bool Game::loadMap(const std::string& mapName, TileMap* target, std::shared_ptr<const MapData>& applied) {
+    // The file is only parsed the first time. If the target already holds the
+    // cached copy the switch is just a pointer swap, otherwise it is one copy.
+    std::shared_ptr<const MapData> data = mapCache->get(mapName);
+    if (!data) {
+        std::cerr << "Failed to load map: " << MapCache::getMapPath(mapName) << std::endl;
         return false;
     }
 
+    if (data != applied) {
+        target->applyMapData(*data);
+        applied = data;
+    }
     return true;
 }
 
 void Game::setCurrentCity(const std::string& cityName) {
     currentCity = cityName;
-    if (currentState == GameState::CITY) {
-        loadMap(currentCity);
-    }
+    loadMap(currentCity, cityMap, cityData);
 }
 
 void Game::setCurrentArena(const std::string& arenaName) {
     currentArena = arenaName;
-    if (currentState == GameState::ARENA) {
-        loadMap(currentArena);
-    }
+    loadMap(currentArena, arenaMap, arenaData);
 }
 
 void Game::shutdownImGui() {
@@ -4,6 +4,7 @@
 #include <SDL2/SDL.h>
 #include <string>
 #include <vector>
+#include <set>
 #include "renderer.h"
 #include "entity.h"
 #include "player.h"
@@ -16,6 +17,12 @@
 #include "ui_panel.h"
 #include "ui_label.h"
 #include "ui_editor.h"
+#include "hot_reloader.h"
+#include "map_cache.h"
+#include "minimap.h"
+#include "fog_overlay.h"
+#include "threat_overlay.h"
+#include "tile_overlay.h"
 
 #include "imgui/imgui.h"
 #include "imgui/backends/imgui_impl_sdl2.h"
@@ -25,7 +32,8 @@
 enum class GameState {
     CITY,
     ARENA,
-    EDITOR
+    EDITOR,
+    PLAYTEST
 };
 
 class Game {
@@ -43,6 +51,10 @@ public:
     void switchToArena();
     void switchToEditor();
 
+    // Plays the editor's current map without saving it, Escape returns to the editor.
+    void startPlaytest(int startX, int startY);
+    void stopPlaytest();
+
     bool loadAssets(Renderer& renderer);
 
     TileMap* getTileMap() const { return tileMap; }
@@ -62,6 +74,10 @@ private:
     Player* player;
     std::vector<Entity*> entities;
 
+    TileMap* cityMap;
+    TileMap* arenaMap;
+    TileMap* editorMap;
+    TileMap* playtestMap;
     TileMap* tileMap;
     MapEditor* mapEditor;
 
@@ -88,12 +104,18 @@ private:
     void renderEditor(Renderer& renderer);
 
     void renderMovementRange(Renderer& renderer);
+    void renderLoadingScreen(Renderer& renderer, float progress);
     void placePlayerInValidPosition();
+    void placePlayerAt(int gridX, int gridY);
 
     std::string currentCity;
     std::string currentArena;
 
-    bool loadMap(const std::string& mapName);
+    // Map data last copied into cityMap and arenaMap, compared against the cache on switch.
+    std::shared_ptr<const MapData> cityData;
+    std::shared_ptr<const MapData> arenaData;
+
+    bool loadMap(const std::string& mapName, TileMap* target, std::shared_ptr<const MapData>& applied);
     void setCurrentCity(const std::string& cityName);
     void setCurrentArena(const std::string& arenaName);
 
@@ -107,6 +129,36 @@ private:
 
     UIEditor* uiEditor;
     void toggleUIEditor();
+
+    Renderer* renderer;
+    std::set<std::string> sceneTextures;
+    void updateSceneTextures(const std::string& scene);
+    void setActiveMap(TileMap* map);
+
+    bool showTextureStats;
+    void renderTextureStatsPanel(Renderer& renderer);
+
+    HotReloader* hotReloader;
+    void processHotReloads();
+
+    MapCache* mapCache;
+
+    Minimap* minimap;
+    void renderMinimap(Renderer& renderer);
+
+    TileOverlay* movementOverlay;
+    TileOverlay* attackOverlay;
+
+    // During combat, enemy reach is shaded and reachable tiles under threat
+    // are split out of the movement preview.
+    ThreatOverlay* threatOverlay;
+    TileOverlay* threatenedMoveOverlay;
+
+    // Arena fog of war follows the player's tile.
+    static const int PLAYER_SIGHT_RADIUS = 7;
+    FogOverlay* fogOverlay;
+    int playerViewer;
+    void updatePlayerViewer();
 };
 
 #endif // GAME_H
\ No newline at end of file
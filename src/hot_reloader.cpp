@@ -0,0 +1,227 @@
+#include "hot_reloader.h"
+#include "map_serializer.h"
+#include "autotile.h"
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const std::chrono::milliseconds DEBOUNCE_DELAY(250);
+const int POLL_INTERVAL_MS = 100;
+
+bool isIgnoredFile(const std::string& name) {
+    return name.empty() || name[0] == '.' || name.back() == '~';
+}
+
+}
+
+HotReloader::HotReloader() : running(false) {
+#ifdef __linux__
+    inotifyFd = -1;
+#endif
+}
+
+HotReloader::~HotReloader() {
+    stop();
+}
+
+bool HotReloader::start(const std::vector<std::string>& watchDirs) {
+    if (running) return true;
+
+    directories = watchDirs;
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK);
+    if (inotifyFd < 0) {
+        std::cerr << "Hot reload disabled, inotify_init1 failed" << std::endl;
+        return false;
+    }
+
+    for (const auto& directory : directories) {
+        int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            std::cerr << "Hot reload cannot watch " << directory << std::endl;
+            continue;
+        }
+        watchDirectories[wd] = directory;
+    }
+#else
+    scanDirectories(false);
+    lastScan = Clock::now();
+#endif
+
+    running = true;
+    watchThread = std::thread(&HotReloader::watchLoop, this);
+
+    std::cout << "Hot reload watching " << directories.size() << " directories" << std::endl;
+    return true;
+}
+
+void HotReloader::stop() {
+    running = false;
+
+    if (watchThread.joinable()) {
+        watchThread.join();
+    }
+
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+    watchDirectories.clear();
+#endif
+}
+
+bool HotReloader::popEvent(HotReloadEvent& event) {
+    std::lock_guard<std::mutex> lock(eventMutex);
+    if (events.empty()) {
+        return false;
+    }
+
+    event = events.front();
+    events.pop_front();
+    return true;
+}
+
+void HotReloader::watchLoop() {
+    while (running) {
+        collectChanges();
+        flushSettledChanges();
+    }
+}
+
+#ifdef __linux__
+
+void HotReloader::collectChanges() {
+    pollfd descriptor = {inotifyFd, POLLIN, 0};
+    if (poll(&descriptor, 1, POLL_INTERVAL_MS) <= 0) {
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* p = buffer; p < buffer + length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            auto directory = watchDirectories.find(event->wd);
+            if (directory == watchDirectories.end() || event->len == 0) continue;
+
+            std::string name = event->name;
+            if (isIgnoredFile(name)) continue;
+
+            pendingChanges[directory->second + "/" + name] = Clock::now();
+        }
+    }
+}
+
+#else
+
+// No inotify here, so fall back to polling modification times.
+void HotReloader::collectChanges() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+
+    if (Clock::now() - lastScan < std::chrono::milliseconds(500)) {
+        return;
+    }
+
+    scanDirectories(true);
+    lastScan = Clock::now();
+}
+
+void HotReloader::scanDirectories(bool recordChanges) {
+    for (const auto& directory : directories) {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file(error)) continue;
+
+            std::string name = entry.path().filename().string();
+            if (isIgnoredFile(name)) continue;
+
+            std::string path = directory + "/" + name;
+            auto writeTime = entry.last_write_time(error);
+
+            auto known = knownWriteTimes.find(path);
+            if (known == knownWriteTimes.end() || known->second != writeTime) {
+                knownWriteTimes[path] = writeTime;
+                if (recordChanges) {
+                    pendingChanges[path] = Clock::now();
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+void HotReloader::flushSettledChanges() {
+    Clock::time_point now = Clock::now();
+
+    auto it = pendingChanges.begin();
+    while (it != pendingChanges.end()) {
+        if (now - it->second >= DEBOUNCE_DELAY) {
+            std::string path = it->first;
+            it = pendingChanges.erase(it);
+            processChange(path);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void HotReloader::processChange(const std::string& path) {
+    std::filesystem::path filePath(path);
+    std::string directory = filePath.parent_path().string();
+    std::string extension = filePath.extension().string();
+
+    HotReloadEvent event;
+    event.path = path;
+
+    if (directory == "assets" && extension == ".png") {
+        event.type = HotReloadType::TEXTURE;
+    }
+    else if (directory == "assets" && filePath.filename() == "manifest.json") {
+        event.type = HotReloadType::MANIFEST;
+    }
+    else if (directory == "maps" && (extension == ".json" || extension == ".bmap")) {
+        event.type = HotReloadType::MAP;
+        std::error_code error;
+        event.writeTime = std::filesystem::last_write_time(path, error);
+        event.map = std::make_shared<MapData>();
+        if (!MapSerializer::load(path, *event.map)) {
+            return;
+        }
+        Autotiler::updateMap(*event.map);
+    }
+    else if (directory == "layouts" && extension == ".json") {
+        event.type = HotReloadType::LAYOUT;
+        try {
+            std::ifstream file(path);
+            if (!file.is_open()) return;
+
+            event.layout = std::make_shared<nlohmann::json>();
+            file >> *event.layout;
+        } catch (const std::exception& e) {
+            std::cerr << "Hot reload skipped " << path << ": " << e.what() << std::endl;
+            return;
+        }
+    }
+    else {
+        return;
+    }
+
+    std::cout << "Hot reload: " << path << " changed" << std::endl;
+
+    std::lock_guard<std::mutex> lock(eventMutex);
+    events.push_back(event);
+}
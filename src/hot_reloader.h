@@ -0,0 +1,74 @@
+#ifndef HOT_RELOADER_H
+#define HOT_RELOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <json.hpp>
+#include "map_data.h"
+
+enum class HotReloadType {
+    TEXTURE,
+    MANIFEST,
+    MAP,
+    LAYOUT
+};
+
+struct HotReloadEvent {
+    HotReloadType type;
+    std::string path;
+    std::shared_ptr<MapData> map;
+    // Modification time of a map file when it was parsed.
+    std::filesystem::file_time_type writeTime;
+    std::shared_ptr<nlohmann::json> layout;
+};
+
+// Watches the asset, map and layout directories on a background thread.
+// Changes are debounced and parsed there, the main thread only polls the
+// results and swaps them in.
+class HotReloader {
+public:
+    HotReloader();
+    ~HotReloader();
+
+    bool start(const std::vector<std::string>& directories);
+    void stop();
+
+    bool popEvent(HotReloadEvent& event);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<std::string> directories;
+    std::thread watchThread;
+    std::atomic<bool> running;
+
+    std::mutex eventMutex;
+    std::deque<HotReloadEvent> events;
+
+    // Path -> time of the most recent change, fired once it has been quiet long enough.
+    std::map<std::string, Clock::time_point> pendingChanges;
+
+#ifdef __linux__
+    int inotifyFd;
+    std::map<int, std::string> watchDirectories;
+#else
+    std::map<std::string, std::filesystem::file_time_type> knownWriteTimes;
+    Clock::time_point lastScan;
+    void scanDirectories(bool recordChanges);
+#endif
+
+    void watchLoop();
+    void collectChanges();
+    void flushSettledChanges();
+    void processChange(const std::string& path);
+};
+
+#endif // HOT_RELOADER_H
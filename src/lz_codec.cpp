@@ -0,0 +1,181 @@
+#include "lz_codec.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5;
+const size_t MATCH_SEARCH_LIMIT = 12;
+const size_t MAX_OFFSET = 65535;
+const int HASH_BITS = 12;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+bool writeLength(uint8_t*& op, uint8_t* opEnd, size_t length) {
+    while (length >= 255) {
+        if (op >= opEnd) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+
+    if (op >= opEnd) return false;
+    *op++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+bool readLength(const uint8_t*& ip, const uint8_t* ipEnd, size_t& length) {
+    uint8_t value;
+    do {
+        if (ip >= ipEnd) return false;
+        value = *ip++;
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+bool writeSequence(uint8_t*& op, uint8_t* opEnd, const uint8_t* literals, size_t literalLength,
+                   size_t offset, size_t matchLength) {
+    if (op >= opEnd) return false;
+    uint8_t* token = op++;
+
+    if (literalLength >= 15) {
+        *token = 15 << 4;
+        if (!writeLength(op, opEnd, literalLength - 15)) return false;
+    } else {
+        *token = static_cast<uint8_t>(literalLength << 4);
+    }
+
+    if (static_cast<size_t>(opEnd - op) < literalLength) return false;
+    std::memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    // The final sequence carries literals only.
+    if (matchLength == 0) return true;
+
+    if (opEnd - op < 2) return false;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+
+    size_t encodedMatch = matchLength - MIN_MATCH;
+    if (encodedMatch >= 15) {
+        *token |= 15;
+        if (!writeLength(op, opEnd, encodedMatch - 15)) return false;
+    } else {
+        *token |= static_cast<uint8_t>(encodedMatch);
+    }
+
+    return true;
+}
+
+}
+
+size_t lzCompressBound(size_t srcSize) {
+    return srcSize + srcSize / 255 + 16;
+}
+
+size_t lzCompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstCapacity;
+    size_t anchor = 0;
+
+    if (srcSize > MATCH_SEARCH_LIMIT) {
+        std::vector<int32_t> table(1 << HASH_BITS, -1);
+        size_t matchStartLimit = srcSize - MATCH_SEARCH_LIMIT;
+        size_t matchEndLimit = srcSize - LAST_LITERALS;
+        size_t ip = 0;
+
+        while (ip < matchStartLimit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t hash = hashSequence(sequence);
+            int32_t candidate = table[hash];
+            table[hash] = static_cast<int32_t>(ip);
+
+            if (candidate < 0 || ip - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                ip++;
+                continue;
+            }
+
+            size_t matchLength = MIN_MATCH;
+            while (ip + matchLength < matchEndLimit && src[candidate + matchLength] == src[ip + matchLength]) {
+                matchLength++;
+            }
+
+            if (!writeSequence(op, opEnd, src + anchor, ip - anchor, ip - candidate, matchLength)) {
+                return 0;
+            }
+
+            ip += matchLength;
+            anchor = ip;
+        }
+    }
+
+    if (!writeSequence(op, opEnd, src + anchor, srcSize - anchor, 0, 0)) {
+        return 0;
+    }
+
+    return static_cast<size_t>(op - dst);
+}
+
+bool lzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* ipEnd = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstSize;
+
+    while (ip < ipEnd) {
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(ip, ipEnd, literalLength)) {
+            return false;
+        }
+
+        if (static_cast<size_t>(ipEnd - ip) < literalLength ||
+            static_cast<size_t>(opEnd - op) < literalLength) {
+            return false;
+        }
+
+        std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == ipEnd) break;
+
+        if (ipEnd - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip, ipEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+
+        if (static_cast<size_t>(opEnd - op) < matchLength) {
+            return false;
+        }
+
+        // Matches may overlap their own output, so copy forward byte by byte.
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLength; i++) {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+
+    return op == opEnd;
+}
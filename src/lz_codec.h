@@ -0,0 +1,17 @@
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-oriented LZ77 codec using the LZ4 block layout: a token with literal and
+// match lengths, the literals, then a 16-bit little endian match offset.
+size_t lzCompressBound(size_t srcSize);
+
+// Returns the compressed size, or 0 if dst is too small.
+size_t lzCompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+
+// dstSize must be the exact decompressed size, corrupt input returns false.
+bool lzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+#endif // LZ_CODEC_H
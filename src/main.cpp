@@ -118,6 +118,7 @@ int main(int argc, char* argv[]) {
         }
 
         game.update();
+        gameRenderer.processLoadedTextures();
 
         ImGui_ImplSDLRenderer2_NewFrame();
         ImGui_ImplSDL2_NewFrame();
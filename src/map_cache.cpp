@@ -0,0 +1,161 @@
+#include "map_cache.h"
+#include "map_serializer.h"
+#include "autotile.h"
+#include <filesystem>
+#include <iostream>
+
+MapCache::MapCache() : stopping(false) {
+}
+
+MapCache::~MapCache() {
+    shutdown();
+}
+
+void MapCache::start() {
+    if (worker.joinable()) return;
+
+    stopping = false;
+    worker = std::thread(&MapCache::workerLoop, this);
+}
+
+void MapCache::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        prefetchQueue.clear();
+    }
+    jobCondition.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<const MapData> MapCache::get(const std::string& mapName) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        loadedCondition.wait(lock, [this, &mapName]() { return loadingMap != mapName; });
+
+        auto it = maps.find(mapName);
+        if (it != maps.end()) {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<const MapData> data = loadFromDisk(mapName);
+    if (data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maps[mapName] = data;
+    }
+    return data;
+}
+
+void MapCache::prefetch(const std::string& mapName) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (maps.count(mapName) > 0 || loadingMap == mapName) return;
+
+        for (const auto& queued : prefetchQueue) {
+            if (queued == mapName) return;
+        }
+        prefetchQueue.push_back(mapName);
+    }
+    jobCondition.notify_one();
+}
+
+void MapCache::store(const std::string& mapName, std::shared_ptr<const MapData> data) {
+    if (mapName.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    generations[mapName]++;
+    if (data) {
+        maps[mapName] = data;
+    } else {
+        maps.erase(mapName);
+    }
+}
+
+void MapCache::invalidate(const std::string& mapName) {
+    store(mapName, nullptr);
+}
+
+void MapCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : maps) {
+        generations[entry.first]++;
+    }
+    maps.clear();
+}
+
+bool MapCache::isCached(const std::string& mapName) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maps.count(mapName) > 0;
+}
+
+std::string MapCache::getMapPath(const std::string& mapName) {
+    std::string mapPath = "maps/" + mapName + ".json";
+    std::string binaryPath = "maps/" + mapName + ".bmap";
+
+    std::error_code error;
+    if (std::filesystem::exists(binaryPath, error)) {
+        if (!std::filesystem::exists(mapPath, error) ||
+            std::filesystem::last_write_time(binaryPath, error) >= std::filesystem::last_write_time(mapPath, error)) {
+            return binaryPath;
+        }
+    }
+
+    return mapPath;
+}
+
+std::string MapCache::getMapName(const std::string& filePath) {
+    std::filesystem::path path(filePath);
+    if (path.parent_path() != "maps") {
+        return "";
+    }
+    return path.stem().string();
+}
+
+void MapCache::workerLoop() {
+    while (true) {
+        std::string mapName;
+        int generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobCondition.wait(lock, [this]() { return stopping || !prefetchQueue.empty(); });
+
+            if (stopping) return;
+
+            mapName = prefetchQueue.front();
+            prefetchQueue.pop_front();
+
+            if (maps.count(mapName) > 0) continue;
+
+            loadingMap = mapName;
+            generation = generations[mapName];
+        }
+
+        std::shared_ptr<const MapData> data = loadFromDisk(mapName);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (data && generations[mapName] == generation && maps.count(mapName) == 0) {
+                maps[mapName] = data;
+                std::cout << "Prefetched map: " << mapName << std::endl;
+            }
+            loadingMap.clear();
+        }
+        loadedCondition.notify_all();
+    }
+}
+
+std::shared_ptr<const MapData> MapCache::loadFromDisk(const std::string& mapName) {
+    std::string mapPath = getMapPath(mapName);
+
+    std::shared_ptr<MapData> data = std::make_shared<MapData>();
+    if (!MapSerializer::load(mapPath, *data)) {
+        return nullptr;
+    }
+
+    Autotiler::updateMap(*data);
+    return data;
+}
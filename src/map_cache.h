@@ -0,0 +1,58 @@
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "map_data.h"
+
+// Parsed maps keyed by map name ("city" for maps/city.json). Scene switches
+// copy from here instead of reading the file again, and the likely next map
+// can be prefetched on a background thread.
+class MapCache {
+public:
+    MapCache();
+    ~MapCache();
+
+    void start();
+    void shutdown();
+
+    // Returns the cached map, loading it now if it is not cached yet. Waits
+    // for an in-flight prefetch of the same map instead of parsing it twice.
+    std::shared_ptr<const MapData> get(const std::string& mapName);
+    void prefetch(const std::string& mapName);
+
+    void store(const std::string& mapName, std::shared_ptr<const MapData> data);
+    void invalidate(const std::string& mapName);
+    void clear();
+
+    bool isCached(const std::string& mapName) const;
+
+    // The .bmap copy is used unless the JSON was edited after it.
+    static std::string getMapPath(const std::string& mapName);
+    // Returns an empty name for files outside maps/.
+    static std::string getMapName(const std::string& filePath);
+
+private:
+    std::map<std::string, std::shared_ptr<const MapData>> maps;
+    std::deque<std::string> prefetchQueue;
+    std::string loadingMap;
+
+    // Bumped on invalidate/store so a prefetch that raced with it is dropped.
+    std::map<std::string, int> generations;
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable jobCondition;
+    std::condition_variable loadedCondition;
+    bool stopping;
+
+    void workerLoop();
+    static std::shared_ptr<const MapData> loadFromDisk(const std::string& mapName);
+};
+
+#endif // MAP_CACHE_H
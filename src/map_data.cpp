@@ -0,0 +1,58 @@
+#include "map_data.h"
+
+MapData::MapData() : width(0), height(0), tileSize(32), autotile(false) {
+    clearPalette();
+}
+
+void MapData::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+
+    size_t count = static_cast<size_t>(width) * height;
+    ground.assign(count, 0);
+    objects.assign(count, 0);
+    walkable.assign(count, 1);
+    for (auto& layer : decorations) {
+        layer.tiles.assign(count, 0);
+    }
+}
+
+uint16_t MapData::internTexture(const std::string& textureID) {
+    auto it = paletteLookup.find(textureID);
+    if (it != paletteLookup.end()) {
+        return it->second;
+    }
+
+    uint16_t paletteIndex = static_cast<uint16_t>(palette.size());
+    palette.push_back(textureID);
+    paletteLookup[textureID] = paletteIndex;
+    return paletteIndex;
+}
+
+const std::string& MapData::getTexture(uint16_t paletteIndex) const {
+    if (paletteIndex < palette.size()) {
+        return palette[paletteIndex];
+    }
+
+    return palette[0];
+}
+
+void MapData::clearPalette() {
+    palette.clear();
+    paletteLookup.clear();
+    internTexture("");
+}
+
+MapDataLayer* MapData::findDecoration(const std::string& name) {
+    for (auto& layer : decorations) {
+        if (layer.name == name) return &layer;
+    }
+    return nullptr;
+}
+
+const MapDataLayer* MapData::findDecoration(const std::string& name) const {
+    for (const auto& layer : decorations) {
+        if (layer.name == name) return &layer;
+    }
+    return nullptr;
+}
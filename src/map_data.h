@@ -0,0 +1,51 @@
+#ifndef MAP_DATA_H
+#define MAP_DATA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// A named texture layer drawn above the objects, same size as the map.
+struct MapDataLayer {
+    std::string name;
+    std::vector<uint16_t> tiles;
+};
+
+// Flat, palette indexed copy of a map's tiles. Maps travel between files,
+// threads and TileMap instances in this form.
+struct MapData {
+    int width;
+    int height;
+    int tileSize;
+
+    // Index 0 is always the empty texture id.
+    std::vector<std::string> palette;
+    std::unordered_map<std::string, uint16_t> paletteLookup;
+
+    std::vector<uint16_t> ground;
+    std::vector<uint16_t> objects;
+    std::vector<uint8_t> walkable;
+
+    // In draw order, bottom first.
+    std::vector<MapDataLayer> decorations;
+
+    // Border tiles are picked by the Autotiler. Off for maps whose borders
+    // were placed by hand, those are never rewritten.
+    bool autotile;
+
+    MapData();
+
+    void resize(int newWidth, int newHeight);
+    int index(int x, int y) const { return y * width + x; }
+    bool contains(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    uint16_t internTexture(const std::string& textureID);
+    const std::string& getTexture(uint16_t paletteIndex) const;
+    void clearPalette();
+
+    MapDataLayer* findDecoration(const std::string& name);
+    const MapDataLayer* findDecoration(const std::string& name) const;
+};
+
+#endif // MAP_DATA_H
@@ -1,12 +1,40 @@
 #include "map_editor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
-#include <json.hpp>
+#include "map_serializer.h"
 #include "imgui/imgui.h"
 
+// Lets the autotiler read the editor's TileMap and write through the undo history and journal.
+class EditorAutotileGrid {
+public:
+    explicit EditorAutotileGrid(MapEditor& editor) : editor(editor) {}
+
+    int getWidth() const { return editor.tileMap->getGridWidth(); }
+    int getHeight() const { return editor.tileMap->getGridHeight(); }
+
+    std::string getObject(int x, int y) const {
+        return editor.tileMap->getObjectTexture(x, y);
+    }
+
+    std::string getGround(int x, int y) const {
+        return editor.tileMap->getGroundTexture(x, y);
+    }
+
+    void setObject(int x, int y, const std::string& textureID) {
+        editor.recordTileValue(x, y, EditLayer::OBJECTS, editor.history.internTexture(textureID));
+    }
+
+private:
+    MapEditor& editor;
+};
+
 MapEditor::MapEditor(TileMap* tileMap) :
     tileMap(tileMap),
+    mapCache(nullptr),
     active(false),
     mouseX(0),
     mouseY(0),
@@ -14,10 +42,27 @@ MapEditor::MapEditor(TileMap* tileMap) :
     gridY(0),
     currentTool(EditorTool::PENCIL),
     currentLayer(EditorLayer::GROUND),
+    currentDecoration(0),
     currentTileIndex(0),
     showPropertyPanel(false),
+    playRequested(false),
+    playStartX(-1),
+    playStartY(-1),
     editingPropertyValue(false),
+    dragStartX(0),
+    dragStartY(0),
+    lastPaintX(0),
+    lastPaintY(0),
+    deferAutotile(false),
+    autotileMinX(0),
+    autotileMinY(0),
+    autotileMaxX(-1),
+    autotileMaxY(-1),
     currentMapName("default"),
+    saveStatusTime(0),
+    unjournaledChanges(false),
+    sdlRenderer(nullptr),
+    showMinimap(true),
     showMapBrowser(false),
     isNamingMap(false),
     isSelectingMap(false),
@@ -32,16 +77,32 @@ MapEditor::MapEditor(TileMap* tileMap) :
     cursorColor(1.0f, 1.0f, 0.0f, 0.4f),
     gridOpacity(0.5f),
     isMouseButtonDown(false),
-    isCtrlPressed(false) {
+    isCtrlPressed(false),
+    hasSelection(false),
+    selectionX(0),
+    selectionY(0),
+    selectionWidth(0),
+    selectionHeight(0),
+    showStampLibrary(false) {
 
     strcpy(inputMapNameBuffer, currentMapName.c_str());
+    stampNameBuffer[0] = '\0';
+    decorationNameBuffer[0] = '\0';
+
+    stampLibrary.load("stamps");
+
+    mapSaver.start();
+    mapIndexer.start("maps", "cache/maps");
 
     initializeAvailableTiles();
     refreshMapList();
 }
 
 MapEditor::~MapEditor() {
-    // Cleanup
+    // Writes out any save that is still queued.
+    mapSaver.shutdown();
+    mapIndexer.shutdown();
+    clearThumbnailTextures();
 }
 
 void MapEditor::initializeAvailableTiles() {
@@ -60,17 +121,18 @@ void MapEditor::handleEvent(SDL_Event& e) {
 
     if (e.type == SDL_MOUSEMOTION) {
         SDL_GetMouseState(&mouseX, &mouseY);
-        tileMap->pixelToGrid(mouseX, mouseY, gridX, gridY);
+        tileMap->pixelToGrid(mouseX + tileMap->getViewX(), mouseY + tileMap->getViewY(), gridX, gridY);
 
         if (isMouseButtonDown && tileMap->isValidGridPosition(gridX, gridY)) {
             switch (currentTool) {
                 case EditorTool::PENCIL:
-                    applyTileAtPosition(gridX, gridY);
-                    break;
                 case EditorTool::ERASER:
-                    eraseTileAtPosition(gridX, gridY);
+                    // Fast drags skip cells between motion events, draw the segment in between.
+                    paintLine(lastPaintX, lastPaintY, gridX, gridY, currentTool == EditorTool::ERASER);
+                    lastPaintX = gridX;
+                    lastPaintY = gridY;
                     break;
-                case EditorTool::PROPERTY_EDITOR:
+                default:
                     break;
             }
         }
@@ -79,28 +141,58 @@ void MapEditor::handleEvent(SDL_Event& e) {
     if (e.type == SDL_MOUSEBUTTONDOWN) {
         ImGuiIO& io = ImGui::GetIO();
         if (!io.WantCaptureMouse) {
-            if (e.button.button == SDL_BUTTON_LEFT) {
+            if (e.button.button == SDL_BUTTON_LEFT && tileMap->isValidGridPosition(gridX, gridY)) {
                 isMouseButtonDown = true;
-                if (tileMap->isValidGridPosition(gridX, gridY)) {
-                    switch (currentTool) {
-                        case EditorTool::PENCIL:
-                            applyTileAtPosition(gridX, gridY);
-                            break;
-                        case EditorTool::ERASER:
-                            eraseTileAtPosition(gridX, gridY);
-                            break;
-                        case EditorTool::PROPERTY_EDITOR:
-                            openPropertyEditor(gridX, gridY);
-                            break;
-                    }
+                dragStartX = lastPaintX = gridX;
+                dragStartY = lastPaintY = gridY;
+
+                // Everything painted until the button is released undoes as one step.
+                history.begin();
+
+                switch (currentTool) {
+                    case EditorTool::PENCIL:
+                        applyTileAtPosition(gridX, gridY);
+                        break;
+                    case EditorTool::ERASER:
+                        eraseTileAtPosition(gridX, gridY);
+                        break;
+                    case EditorTool::PROPERTY_EDITOR:
+                        openPropertyEditor(gridX, gridY);
+                        break;
+                    case EditorTool::FILL:
+                        floodFill(gridX, gridY);
+                        break;
+                    case EditorTool::STAMP:
+                        placeChunk(gridX, gridY, activeStamp);
+                        break;
+                    case EditorTool::RECTANGLE:
+                    case EditorTool::LINE:
+                    case EditorTool::SELECT:
+                        break;
                 }
             }
         }
     }
 
     if (e.type == SDL_MOUSEBUTTONUP) {
-        if (e.button.button == SDL_BUTTON_LEFT) {
+        if (e.button.button == SDL_BUTTON_LEFT && isMouseButtonDown) {
+            int endX = std::max(0, std::min(gridX, tileMap->getGridWidth() - 1));
+            int endY = std::max(0, std::min(gridY, tileMap->getGridHeight() - 1));
+
+            if (currentTool == EditorTool::RECTANGLE) {
+                fillRectangle(dragStartX, dragStartY, endX, endY);
+            } else if (currentTool == EditorTool::LINE) {
+                paintLine(dragStartX, dragStartY, endX, endY, false);
+            } else if (currentTool == EditorTool::SELECT) {
+                hasSelection = true;
+                selectionX = std::min(dragStartX, endX);
+                selectionY = std::min(dragStartY, endY);
+                selectionWidth = std::abs(endX - dragStartX) + 1;
+                selectionHeight = std::abs(endY - dragStartY) + 1;
+            }
+
             isMouseButtonDown = false;
+            history.commit();
         }
     }
 
@@ -121,10 +213,29 @@ void MapEditor::handleEvent(SDL_Event& e) {
                     case SDLK_a:
                         selectAll();
                         break;
+                    case SDLK_c:
+                        copySelection();
+                        break;
+                    case SDLK_x:
+                        cutSelection();
+                        break;
+                    case SDLK_v:
+                        pasteClipboard();
+                        break;
                 }
             }
+            else if (e.key.keysym.sym >= SDLK_1 && e.key.keysym.sym <= SDLK_8) {
+                currentTool = static_cast<EditorTool>(e.key.keysym.sym - SDLK_1);
+            }
+            else if (e.key.keysym.sym == SDLK_DELETE) {
+                deleteSelection();
+            }
+            else if (e.key.keysym.sym == SDLK_F5) {
+                requestPlay(gridX, gridY);
+            }
             else if (e.key.keysym.sym == SDLK_ESCAPE) {
                 hasTileSelected = false;
+                hasSelection = false;
             }
         }
     }
@@ -137,6 +248,16 @@ void MapEditor::handleEvent(SDL_Event& e) {
 }
 
 void MapEditor::update() {
+    processSaveResults();
+
+    // Fold a long journal back into the base file in the background.
+    if (journal.isOpen() && compactingMapPath.empty() && journal.getRecordCount() >= JOURNAL_COMPACT_RECORDS &&
+        !journal.isCompacting() && std::filesystem::exists(journal.getMapPath())) {
+        std::shared_ptr<MapData> data = std::make_shared<MapData>();
+        tileMap->toMapData(*data);
+        queueFullSave(journal.getMapPath(), data);
+    }
+
     if (!active) return;
 }
 
@@ -168,6 +289,53 @@ void MapEditor::render(Renderer& renderer) {
         renderer.drawRect(pixelX, pixelY, tileMap->getTileSize(), tileMap->getTileSize());
     }
 
+    // Preview of the shape that will be drawn when the button is released.
+    if (isMouseButtonDown && tileMap->isValidGridPosition(gridX, gridY)) {
+        int tileSize = tileMap->getTileSize();
+
+        if (currentTool == EditorTool::RECTANGLE) {
+            int minX = std::min(dragStartX, gridX);
+            int minY = std::min(dragStartY, gridY);
+            int width = std::abs(gridX - dragStartX) + 1;
+            int height = std::abs(gridY - dragStartY) + 1;
+            renderer.drawRect(minX * tileSize, minY * tileSize, width * tileSize, height * tileSize);
+        } else if (currentTool == EditorTool::LINE) {
+            std::vector<std::pair<int, int>> cells;
+            traceLine(dragStartX, dragStartY, gridX, gridY, cells);
+            for (const auto& cell : cells) {
+                renderer.drawRect(cell.first * tileSize, cell.second * tileSize, tileSize, tileSize);
+            }
+        } else if (currentTool == EditorTool::SELECT) {
+            int minX = std::min(dragStartX, gridX);
+            int minY = std::min(dragStartY, gridY);
+            int width = std::abs(gridX - dragStartX) + 1;
+            int height = std::abs(gridY - dragStartY) + 1;
+            renderer.drawRect(minX * tileSize, minY * tileSize, width * tileSize, height * tileSize);
+        }
+    }
+
+    if (currentTool == EditorTool::STAMP) {
+        renderStampPreview(renderer);
+    }
+
+    if (hasSelection) {
+        int tileSize = tileMap->getTileSize();
+        int left = selectionX * tileSize;
+        int top = selectionY * tileSize;
+        int width = selectionWidth * tileSize;
+        int height = selectionHeight * tileSize;
+
+        renderer.setDrawColor(
+            static_cast<Uint8>(selectedTileColor.x * 255),
+            static_cast<Uint8>(selectedTileColor.y * 255),
+            static_cast<Uint8>(selectedTileColor.z * 255),
+            255);
+        renderer.drawRect(left, top, width, 2);
+        renderer.drawRect(left, top + height - 2, width, 2);
+        renderer.drawRect(left, top, 2, height);
+        renderer.drawRect(left + width - 2, top, 2, height);
+    }
+
     if (hasTileSelected) {
         int pixelX, pixelY;
         tileMap->gridToPixel(selectedTileX, selectedTileY, pixelX, pixelY);
@@ -180,6 +348,8 @@ void MapEditor::render(Renderer& renderer) {
         renderer.drawRect(pixelX, pixelY, tileMap->getTileSize(), tileMap->getTileSize());
     }
 
+    sdlRenderer = renderer.getRenderer();
+    minimap.update(renderer, tileMap);
     renderImGuiInterface();
 }
 
@@ -212,21 +382,43 @@ void MapEditor::renderImGuiInterface() {
         }
 
         if (ImGui::BeginMenu("Edit")) {
-            if (ImGui::MenuItem("Undo", "Ctrl+Z", false, !undoStack.empty())) {
+            if (ImGui::MenuItem("Undo", "Ctrl+Z", false, history.canUndo())) {
                 undo();
             }
-            if (ImGui::MenuItem("Redo", "Ctrl+Y", false, !redoStack.empty())) {
+            if (ImGui::MenuItem("Redo", "Ctrl+Y", false, history.canRedo())) {
                 redo();
             }
             ImGui::Separator();
             if (ImGui::MenuItem("Select All", "Ctrl+A")) {
                 selectAll();
             }
+            ImGui::Separator();
+            if (ImGui::MenuItem("Cut", "Ctrl+X", false, hasSelection)) {
+                cutSelection();
+            }
+            if (ImGui::MenuItem("Copy", "Ctrl+C", false, hasSelection)) {
+                copySelection();
+            }
+            if (ImGui::MenuItem("Paste", "Ctrl+V", false, clipboard != nullptr)) {
+                pasteClipboard();
+            }
+            if (ImGui::MenuItem("Delete", "Del", false, hasSelection)) {
+                deleteSelection();
+            }
+            ImGui::EndMenu();
+        }
+
+        if (ImGui::BeginMenu("Play")) {
+            if (ImGui::MenuItem("Play Here", "F5")) {
+                requestPlay(hasTileSelected ? selectedTileX : -1, hasTileSelected ? selectedTileY : -1);
+            }
             ImGui::EndMenu();
         }
 
         if (ImGui::BeginMenu("View")) {
             ImGui::MenuItem("Properties Panel", NULL, &showPropertyPanel);
+            ImGui::MenuItem("Stamp Library", NULL, &showStampLibrary);
+            ImGui::MenuItem("Minimap", NULL, &showMinimap);
             ImGui::Separator();
             ImGui::MenuItem("ImGui Demo Window", NULL, &showDemoWindow);
             ImGui::MenuItem("ImGui Metrics", NULL, &showMetricsWindow);
@@ -239,6 +431,14 @@ void MapEditor::renderImGuiInterface() {
 
     renderToolsPanel();
 
+    if (showStampLibrary) {
+        renderStampLibrary();
+    }
+
+    if (showMinimap) {
+        renderMinimap();
+    }
+
     renderLayersPanel();
 
     renderTilePalette();
@@ -268,10 +468,10 @@ void MapEditor::renderImGuiInterface() {
 
 void MapEditor::renderToolsPanel() {
     ImGui::SetNextWindowPos(ImVec2(10, 30), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(180, 120), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(180, 290), ImGuiCond_FirstUseEver);
 
     if (ImGui::Begin("Tools", nullptr)) {
-        const char* toolNames[] = { "Pencil", "Eraser", "Property Editor" };
+        const char* toolNames[] = { "Pencil", "Eraser", "Property Editor", "Fill", "Rectangle", "Line", "Select", "Stamp" };
         int toolIndex = static_cast<int>(currentTool);
 
         if (ImGui::Combo("Tool", &toolIndex, toolNames, IM_ARRAYSIZE(toolNames))) {
@@ -291,39 +491,127 @@ void MapEditor::renderToolsPanel() {
         if (ImGui::Button("Property Editor (3)", ImVec2(150, 0))) {
             currentTool = EditorTool::PROPERTY_EDITOR;
         }
+
+        if (ImGui::Button("Fill (4)", ImVec2(150, 0))) {
+            currentTool = EditorTool::FILL;
+        }
+
+        if (ImGui::Button("Rectangle (5)", ImVec2(150, 0))) {
+            currentTool = EditorTool::RECTANGLE;
+        }
+
+        if (ImGui::Button("Line (6)", ImVec2(150, 0))) {
+            currentTool = EditorTool::LINE;
+        }
+
+        if (ImGui::Button("Select (7)", ImVec2(150, 0))) {
+            currentTool = EditorTool::SELECT;
+        }
+
+        if (ImGui::Button("Stamp (8)", ImVec2(150, 0))) {
+            currentTool = EditorTool::STAMP;
+            showStampLibrary = true;
+        }
+
+        ImGui::Separator();
+        bool autotile = tileMap->isAutotiled();
+        if (ImGui::Checkbox("Autotile borders", &autotile)) {
+            setAutotile(autotile);
+        }
     }
     ImGui::End();
 }
 
 void MapEditor::renderLayersPanel() {
     ImGui::SetNextWindowPos(ImVec2(10, 160), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(180, 120), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(200, 260), ImGuiCond_FirstUseEver);
 
     if (ImGui::Begin("Layers", nullptr)) {
-        const char* layerNames[] = { "Ground", "Objects", "Collision" };
-        int layerIndex = static_cast<int>(currentLayer);
+        const std::vector<TileLayer*>& layers = tileMap->getLayers();
+        int currentIndex = getCurrentLayerIndex();
+
+        // Listed top to bottom the way they are drawn, the first row is on top.
+        for (int i = static_cast<int>(layers.size()) - 1; i >= 0; i--) {
+            TileLayer* layer = layers[i];
+            ImGui::PushID(i);
 
-        if (ImGui::Combo("Layer", &layerIndex, layerNames, IM_ARRAYSIZE(layerNames))) {
-            currentLayer = static_cast<EditorLayer>(layerIndex);
+            bool visible = layer->isVisible();
+            if (ImGui::Checkbox("##visible", &visible)) {
+                layer->setVisible(visible);
+            }
+            ImGui::SameLine();
+            if (ImGui::Selectable(layer->getName().c_str(), i == currentIndex)) {
+                selectLayerIndex(i);
+            }
+
+            int opacity = layer->getOpacity();
+            ImGui::SetNextItemWidth(-1);
+            if (ImGui::SliderInt("##opacity", &opacity, 0, 255, "Opacity %d")) {
+                layer->setOpacity(static_cast<Uint8>(opacity));
+            }
+
+            ImGui::PopID();
         }
 
         ImGui::Separator();
 
-        if (ImGui::Button("Ground (Q)", ImVec2(150, 0))) {
-            currentLayer = EditorLayer::GROUND;
+        ImGui::SetNextItemWidth(110);
+        ImGui::InputText("##decorationName", decorationNameBuffer, sizeof(decorationNameBuffer));
+        ImGui::SameLine();
+        if (ImGui::Button("Add") && tileMap->addDecorationLayer(decorationNameBuffer)) {
+            currentLayer = EditorLayer::DECORATION;
+            currentDecoration = tileMap->getDecorationCount() - 1;
+            decorationNameBuffer[0] = '\0';
+            unjournaledChanges = true;
         }
 
-        if (ImGui::Button("Objects (W)", ImVec2(150, 0))) {
-            currentLayer = EditorLayer::OBJECTS;
-        }
+        if (currentLayer == EditorLayer::DECORATION && ImGui::Button("Remove Layer", ImVec2(-1, 0))) {
+            // Later decorations shift down, so recorded edits would land on the wrong layer.
+            tileMap->removeDecorationLayer(currentDecoration);
+            history.clear();
+            unjournaledChanges = true;
 
-        if (ImGui::Button("Collision (E)", ImVec2(150, 0))) {
-            currentLayer = EditorLayer::COLLISION;
+            if (tileMap->getDecorationCount() == 0) {
+                currentLayer = EditorLayer::OBJECTS;
+            }
+            currentDecoration = std::max(0, std::min(currentDecoration, tileMap->getDecorationCount() - 1));
         }
     }
     ImGui::End();
 }
 
+int MapEditor::getCurrentLayerIndex() const {
+    switch (currentLayer) {
+        case EditorLayer::GROUND:
+            return 0;
+        case EditorLayer::OBJECTS:
+            return 1;
+        case EditorLayer::DECORATION:
+            if (tileMap->getDecorationLayer(currentDecoration)) {
+                return 2 + currentDecoration;
+            }
+            break;
+        case EditorLayer::COLLISION:
+            break;
+    }
+    return static_cast<int>(tileMap->getLayers().size()) - 1;
+}
+
+void MapEditor::selectLayerIndex(int index) {
+    int last = static_cast<int>(tileMap->getLayers().size()) - 1;
+
+    if (index == 0) {
+        currentLayer = EditorLayer::GROUND;
+    } else if (index == 1) {
+        currentLayer = EditorLayer::OBJECTS;
+    } else if (index == last) {
+        currentLayer = EditorLayer::COLLISION;
+    } else {
+        currentLayer = EditorLayer::DECORATION;
+        currentDecoration = index - 2;
+    }
+}
+
 void MapEditor::renderTilePalette() {
     ImGui::SetNextWindowPos(ImVec2(10, 290), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(180, 300), ImGuiCond_FirstUseEver);
@@ -355,21 +643,21 @@ void MapEditor::renderPropertiesPanel() {
 
     if (ImGui::Begin("Properties", &showPropertyPanel)) {
         if (hasTileSelected && tileMap->isValidGridPosition(selectedTileX, selectedTileY)) {
-            Tile* tile = tileMap->getTileAt(selectedTileX, selectedTileY);
-            if (tile) {
-                ImGui::Text("Selected Tile: %d,%d", selectedTileX, selectedTileY);
-                ImGui::Separator();
-
-                bool isWalkable = tile->getProperty("walkable", true);
-                if (ImGui::Checkbox("Walkable", &isWalkable)) {
-                    tile->setProperty("walkable", isWalkable);
-                }
+            ImGui::Text("Selected Tile: %d,%d", selectedTileX, selectedTileY);
+            ImGui::Separator();
+
+            bool isWalkable = tileMap->isWalkable(selectedTileX, selectedTileY);
+            if (ImGui::Checkbox("Walkable", &isWalkable)) {
+                editTile(selectedTileX, selectedTileY, EditLayer::WALKABLE, isWalkable ? 1 : 0);
+            }
 
-                std::string textureID = tile->getProperty<std::string>("textureID", "");
-                ImGui::Text("Texture ID: %s", textureID.c_str());
+            ImGui::Text("Texture ID: %s", tileMap->getGroundTexture(selectedTileX, selectedTileY).c_str());
+            ImGui::Text("Object Texture: %s", tileMap->getObjectTexture(selectedTileX, selectedTileY).c_str());
 
-                std::string objectTexture = tile->getProperty<std::string>("objectTexture", "");
-                ImGui::Text("Object Texture: %s", objectTexture.c_str());
+            for (int i = 0; i < tileMap->getDecorationCount(); i++) {
+                TileLayer* layer = tileMap->getDecorationLayer(i);
+                ImGui::Text("%s: %s", layer->getName().c_str(),
+                            tileMap->getTexture(layer->get(selectedTileX, selectedTileY)).c_str());
             }
         } else {
             ImGui::Text("No tile selected");
@@ -380,9 +668,23 @@ void MapEditor::renderPropertiesPanel() {
     ImGui::End();
 }
 
+// Index times come from std::filesystem's clock, which has no portable
+// calendar conversion in C++17, so the browser shows the age instead.
+static std::string formatAge(int64_t modifiedTime) {
+    using FileClock = std::filesystem::file_time_type::clock;
+
+    FileClock::duration age(FileClock::now().time_since_epoch().count() - modifiedTime);
+    long long minutes = std::chrono::duration_cast<std::chrono::minutes>(age).count();
+
+    if (minutes < 1) return "just now";
+    if (minutes < 60) return std::to_string(minutes) + " min ago";
+    if (minutes < 60 * 24) return std::to_string(minutes / 60) + " h ago";
+    return std::to_string(minutes / (60 * 24)) + " days ago";
+}
+
 void MapEditor::renderMapBrowser() {
-    ImGui::SetNextWindowPos(ImVec2(200, 150), ImGuiCond_Always);
-    ImGui::SetNextWindowSize(ImVec2(400, 300), ImGuiCond_Always);
+    ImGui::SetNextWindowPos(ImVec2(200, 120), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(isNamingMap ? 400 : 520, isNamingMap ? 300 : 480), ImGuiCond_Always);
 
     const char* title = isNamingMap ? "Save Map As" : "Open Map";
 
@@ -416,17 +718,69 @@ void MapEditor::renderMapBrowser() {
             showMapBrowser = false;
         }
     } else if (isSelectingMap) {
+        std::shared_ptr<const MapIndex> index = mapIndexer.getSnapshot();
+
         ImGui::Text("Select a Map:");
+        if (mapIndexer.isScanning()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(indexing...)");
+        }
         ImGui::Separator();
 
-        for (const auto& mapName : availableMaps) {
-            if (ImGui::Selectable(mapName.c_str(), currentMapName == mapName)) {
-                currentMapName = mapName;
-                loadMap(getMapPath(currentMapName));
-                showMapBrowser = false;
+        ImGui::BeginChild("##MapList", ImVec2(0, -ImGui::GetFrameHeightWithSpacing() - 4));
+
+        if (index->empty() && !mapIndexer.isScanning()) {
+            ImGui::TextDisabled("No maps in maps/");
+        }
+
+        // Only the visible rows are laid out, so thousands of maps cost the same as a screenful.
+        const ImVec2 thumbnailSize(64, 48);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(index->size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                const MapIndexEntry& entry = (*index)[i];
+                ImGui::PushID(i);
+
+                ImVec2 rowStart = ImGui::GetCursorPos();
+                if (ImGui::Selectable("##Map", currentMapName == entry.name, ImGuiSelectableFlags_AllowOverlap,
+                                      ImVec2(0, thumbnailSize.y))) {
+                    currentMapName = entry.name;
+                    loadMap(getMapPath(currentMapName));
+                    showMapBrowser = false;
+                }
+                ImGui::SetCursorPos(rowStart);
+
+                SDL_Texture* thumbnail = getThumbnailTexture(entry);
+                if (thumbnail) {
+                    // Keep the map's aspect ratio inside the thumbnail slot.
+                    float scale = std::min(thumbnailSize.x / entry.thumbnailWidth, thumbnailSize.y / entry.thumbnailHeight);
+                    ImGui::Image(reinterpret_cast<ImTextureID>(thumbnail),
+                                 ImVec2(entry.thumbnailWidth * scale, entry.thumbnailHeight * scale));
+                } else {
+                    ImGui::Dummy(thumbnailSize);
+                }
+
+                ImGui::SameLine(thumbnailSize.x + 16);
+                ImGui::BeginGroup();
+                ImGui::Text("%s", entry.name.c_str());
+                if (entry.failed) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Failed to read %s", entry.path.c_str());
+                } else if (entry.indexed) {
+                    ImGui::TextDisabled("%dx%d  %d ground  %d objects  %d walkable",
+                                        entry.width, entry.height, entry.groundTiles, entry.objectTiles, entry.walkableTiles);
+                    ImGui::TextDisabled("%.1f KB  modified %s", entry.fileSize / 1024.0f, formatAge(entry.modifiedTime).c_str());
+                } else {
+                    ImGui::TextDisabled("...");
+                }
+                ImGui::EndGroup();
+
+                ImGui::PopID();
             }
         }
+        clipper.End();
 
+        ImGui::EndChild();
         ImGui::Separator();
 
         if (ImGui::Button("Cancel", ImVec2(120, 0))) {
@@ -455,12 +809,21 @@ void MapEditor::renderStatusBar() {
 
     ImGui::SameLine(300);
 
-    const char* toolNames[] = { "Pencil", "Eraser", "Property Editor" };
-    const char* layerNames[] = { "Ground", "Objects", "Collision" };
-
+    const char* toolNames[] = { "Pencil", "Eraser", "Property Editor", "Fill", "Rectangle", "Line", "Select", "Stamp" };
     ImGui::Text("Tool: %s | Layer: %s",
                 toolNames[static_cast<int>(currentTool)],
-                layerNames[static_cast<int>(currentLayer)]);
+                tileMap->getLayers()[getCurrentLayerIndex()]->getName().c_str());
+
+    // Failures stay up until the next save, everything else fades after a few seconds.
+    bool saveFailed = saveStatus.compare(0, 11, "Save failed") == 0;
+    if (!saveStatus.empty() && (mapSaver.isSaving() || saveFailed || SDL_GetTicks() - saveStatusTime < 3000)) {
+        ImGui::SameLine(600);
+        if (saveFailed) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", saveStatus.c_str());
+        } else {
+            ImGui::Text("%s", saveStatus.c_str());
+        }
+    }
 
     ImGui::SameLine(ImGui::GetWindowWidth() - 100);
 
@@ -468,10 +831,12 @@ void MapEditor::renderStatusBar() {
     if (ImGui::IsItemHovered()) {
         ImGui::BeginTooltip();
         ImGui::Text("Map Editor Controls:");
-        ImGui::Text("1-3: Change tools");
+        ImGui::Text("1-8: Change tools");
         ImGui::Text("Q-E: Change layers");
         ImGui::Text("Ctrl+S: Save map");
         ImGui::Text("Ctrl+L: Load map");
+        ImGui::Text("Ctrl+X/C/V: Cut, copy, paste selection");
+        ImGui::Text("F5: Play from the hovered tile");
         ImGui::EndTooltip();
     }
 
@@ -479,90 +844,172 @@ void MapEditor::renderStatusBar() {
 }
 
 void MapEditor::applyTileAtPosition(int gridX, int gridY) {
-    if (currentTileIndex >= 0 && currentTileIndex < availableTiles.size()) {
-        TileTexture& selectedTile = availableTiles[currentTileIndex];
-
-        Tile* tile = tileMap->getTileAt(gridX, gridY);
-        if (tile) {
-            TileAction action;
-            action.gridX = gridX;
-            action.gridY = gridY;
-            action.layer = currentLayer;
-
-            switch (currentLayer) {
-                case EditorLayer::GROUND:
-                    action.oldTextureID = tile->getProperty<std::string>("textureID", "");
-                    action.newTextureID = selectedTile.id;
-                    if (action.oldTextureID == action.newTextureID) {
-                        return;
-                    }
-                    tileMap->setTileTexture(gridX, gridY, selectedTile.id);
-                    break;
-                case EditorLayer::OBJECTS:
-                    action.oldObjectTexture = tile->getProperty<std::string>("objectTexture", "");
-                    action.newObjectTexture = selectedTile.id;
-                    if (action.oldObjectTexture == action.newObjectTexture) {
-                        return;
-                    }
-                    tile->setProperty("objectTexture", selectedTile.id);
-                    break;
-                case EditorLayer::COLLISION:
-                    action.oldWalkable = tile->getProperty("walkable", true);
-                    action.newWalkable = selectedTile.walkable;
-                    if (action.oldWalkable == action.newWalkable) {
-                        return;
-                    }
-                    tile->setProperty("walkable", selectedTile.walkable);
-                    break;
-            }
+    EditLayer layer;
+    uint16_t value;
+    if (getBrushValue(false, layer, value)) {
+        editTile(gridX, gridY, layer, value);
+    }
+}
+
+void MapEditor::eraseTileAtPosition(int gridX, int gridY) {
+    EditLayer layer;
+    uint16_t value;
+    if (getBrushValue(true, layer, value)) {
+        editTile(gridX, gridY, layer, value);
+    }
+}
+
+bool MapEditor::getBrushValue(bool erase, EditLayer& layer, uint16_t& value) {
+    switch (currentLayer) {
+        case EditorLayer::GROUND:
+            layer = EditLayer::GROUND;
+            break;
+        case EditorLayer::OBJECTS:
+            layer = EditLayer::OBJECTS;
+            break;
+        case EditorLayer::COLLISION:
+            layer = EditLayer::WALKABLE;
+            break;
+        case EditorLayer::DECORATION:
+            if (!tileMap->getDecorationLayer(currentDecoration)) return false;
+            layer = getDecorationEditLayer(currentDecoration);
+            break;
+    }
+
+    if (erase) {
+        value = layer == EditLayer::WALKABLE ? 1 : 0;
+        return true;
+    }
+
+    if (currentTileIndex < 0 || currentTileIndex >= static_cast<int>(availableTiles.size())) {
+        return false;
+    }
+
+    const TileTexture& selectedTile = availableTiles[currentTileIndex];
+    if (layer == EditLayer::WALKABLE) {
+        value = selectedTile.walkable ? 1 : 0;
+    } else {
+        value = history.internTexture(selectedTile.id);
+    }
+    return true;
+}
 
-            recordAction(action);
+void MapEditor::traceLine(int startX, int startY, int endX, int endY, std::vector<std::pair<int, int>>& cells) {
+    int dx = std::abs(endX - startX);
+    int dy = -std::abs(endY - startY);
+    int stepX = startX < endX ? 1 : -1;
+    int stepY = startY < endY ? 1 : -1;
+    int error = dx + dy;
+
+    int x = startX;
+    int y = startY;
+    while (true) {
+        cells.push_back({x, y});
+        if (x == endX && y == endY) break;
+
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            x += stepX;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            y += stepY;
         }
     }
 }
 
-void MapEditor::eraseTileAtPosition(int gridX, int gridY) {
-    Tile* tile = tileMap->getTileAt(gridX, gridY);
-    if (tile) {
-        TileAction action;
-        action.gridX = gridX;
-        action.gridY = gridY;
-        action.layer = currentLayer;
-
-        switch (currentLayer) {
-            case EditorLayer::GROUND:
-                action.oldTextureID = tile->getProperty<std::string>("textureID", "");
-                action.newTextureID = "";
-                if (action.oldTextureID.empty()) {
-                    return;
-                }
-                tileMap->setTileTexture(gridX, gridY, "");
-                break;
-            case EditorLayer::OBJECTS:
-                action.oldObjectTexture = tile->getProperty<std::string>("objectTexture", "");
-                action.newObjectTexture = "";
-                if (action.oldObjectTexture.empty()) {
-                    return;
-                }
-                tile->setProperty("objectTexture", "");
-                break;
-            case EditorLayer::COLLISION:
-                action.oldWalkable = tile->getProperty("walkable", false);
-                action.newWalkable = true;
-                if (action.oldWalkable == true) {
-                    return;
-                }
-                tile->setProperty("walkable", true);
-                break;
+void MapEditor::paintLine(int startX, int startY, int endX, int endY, bool erase) {
+    EditLayer layer;
+    uint16_t value;
+    if (!getBrushValue(erase, layer, value)) return;
+
+    std::vector<std::pair<int, int>> cells;
+    traceLine(startX, startY, endX, endY, cells);
+
+    beginShapeEdit();
+    for (const auto& cell : cells) {
+        editTile(cell.first, cell.second, layer, value);
+    }
+    endShapeEdit();
+}
+
+void MapEditor::fillRectangle(int startX, int startY, int endX, int endY) {
+    EditLayer layer;
+    uint16_t value;
+    if (!getBrushValue(false, layer, value)) return;
+
+    beginShapeEdit();
+    for (int y = std::min(startY, endY); y <= std::max(startY, endY); y++) {
+        for (int x = std::min(startX, endX); x <= std::max(startX, endX); x++) {
+            editTile(x, y, layer, value);
         }
+    }
+    endShapeEdit();
+}
+
+void MapEditor::floodFill(int startX, int startY) {
+    EditLayer layer;
+    uint16_t value;
+    if (!getBrushValue(false, layer, value)) return;
+    if (!tileMap->isValidGridPosition(startX, startY)) return;
 
-        recordAction(action);
+    int width = tileMap->getGridWidth();
+    int height = tileMap->getGridHeight();
+
+    // Scan a flat copy of the layer's palette indices instead of querying the map per cell.
+    std::vector<uint16_t> values(width * height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            values[y * width + x] = getLayerValue(x, y, layer);
+        }
     }
+
+    uint16_t target = values[startY * width + startX];
+    if (target == value) return;
+
+    std::vector<std::pair<int, int>> seeds;
+    seeds.push_back({startX, startY});
+
+    beginShapeEdit();
+
+    while (!seeds.empty()) {
+        int x = seeds.back().first;
+        int y = seeds.back().second;
+        seeds.pop_back();
+
+        if (values[y * width + x] != target) continue;
+
+        int left = x;
+        while (left > 0 && values[y * width + left - 1] == target) left--;
+        int right = x;
+        while (right < width - 1 && values[y * width + right + 1] == target) right++;
+
+        for (int i = left; i <= right; i++) {
+            values[y * width + i] = value;
+            editTile(i, y, layer, value);
+        }
+
+        // One seed per run of matching cells in the rows above and below.
+        for (int neighbourY = y - 1; neighbourY <= y + 1; neighbourY += 2) {
+            if (neighbourY < 0 || neighbourY >= height) continue;
+
+            bool inRun = false;
+            for (int i = left; i <= right; i++) {
+                bool matches = values[neighbourY * width + i] == target;
+                if (matches && !inRun) {
+                    seeds.push_back({i, neighbourY});
+                }
+                inRun = matches;
+            }
+        }
+    }
+
+    endShapeEdit();
 }
 
 void MapEditor::openPropertyEditor(int gridX, int gridY) {
-    Tile* tile = tileMap->getTileAt(gridX, gridY);
-    if (tile) {
+    if (tileMap->isValidGridPosition(gridX, gridY)) {
         selectedTileX = gridX;
         selectedTileY = gridY;
         hasTileSelected = true;
@@ -573,211 +1020,566 @@ void MapEditor::openPropertyEditor(int gridX, int gridY) {
 bool MapEditor::saveMap(const std::string& filename) {
     try {
         std::filesystem::create_directories("maps");
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving map: " << e.what() << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<MapData> data = std::make_shared<MapData>();
+    tileMap->toMapData(*data);
+
+    if (mapCache) {
+        mapCache->store(MapCache::getMapName(filename), data);
+    }
+
+    // Saving the map that is being journaled only has to make the journal durable.
+    bool journaled = journal.isOpen() && journal.getMapPath() == filename && std::filesystem::exists(filename) &&
+                     !unjournaledChanges;
+    if (journaled && (journal.getRecordCount() < JOURNAL_COMPACT_RECORDS || journal.isCompacting())) {
+        if (!journal.sync()) {
+            saveStatus = "Save failed: " + filename;
+            saveStatusTime = SDL_GetTicks();
+            return false;
+        }
+
+        saveStatus = "Saved " + std::to_string(journal.getRecordCount()) + " journaled edits";
+        saveStatusTime = SDL_GetTicks();
+        return true;
+    }
+
+    if (journal.getMapPath() != filename) {
+        journal.open(filename);
+    }
+    queueFullSave(filename, data);
+    unjournaledChanges = false;
+
+    loadedMapPath = filename;
+    return true;
+}
 
-        nlohmann::json mapJson;
+void MapEditor::queueFullSave(const std::string& filename, const std::shared_ptr<const MapData>& data) {
+    // Only the snapshot happens on this thread, serializing and writing run on the saver thread.
+    // Records up to the snapshot move aside and are dropped once the new base file is written.
+    if (journal.beginCompaction()) {
+        compactingMapPath = filename;
+    }
+
+    mapSaver.queueSave(filename, data);
+
+    // Keep an existing binary copy in sync, the game prefers it over the JSON.
+    if (!MapSerializer::isBinaryPath(filename)) {
+        std::filesystem::path binaryPath(filename);
+        binaryPath.replace_extension(".bmap");
+
+        if (std::filesystem::exists(binaryPath)) {
+            mapSaver.queueSave(binaryPath.string(), data);
+        }
+    }
 
-        mapJson["width"] = tileMap->getGridWidth();
-        mapJson["height"] = tileMap->getGridHeight();
-        mapJson["tileSize"] = tileMap->getTileSize();
+    saveStatus = "Saving " + filename + "...";
+    saveStatusTime = SDL_GetTicks();
+}
 
-        nlohmann::json tilesJson = nlohmann::json::array();
+void MapEditor::journalTile(int gridX, int gridY) {
+    if (!tileMap->isValidGridPosition(gridX, gridY) || !journal.isOpen()) return;
 
-        for (int y = 0; y < tileMap->getGridHeight(); y++) {
-            for (int x = 0; x < tileMap->getGridWidth(); x++) {
-                Tile* tile = tileMap->getTileAt(x, y);
-                if (tile) {
-                    nlohmann::json tileJson;
-                    tileJson["x"] = x;
-                    tileJson["y"] = y;
-                    tileJson["walkable"] = tile->getProperty("walkable", false);
-                    tileJson["textureID"] = tile->getProperty<std::string>("textureID", "");
-                    tileJson["objectTexture"] = tile->getProperty<std::string>("objectTexture", "");
+    journal.appendTile(gridX, gridY,
+                       tileMap->getGroundTexture(gridX, gridY),
+                       tileMap->getObjectTexture(gridX, gridY),
+                       tileMap->isWalkable(gridX, gridY));
+}
 
-                    tilesJson.push_back(tileJson);
+void MapEditor::processSaveResults() {
+    MapSaveResult result;
+    while (mapSaver.popResult(result)) {
+        if (result.filename == compactingMapPath) {
+            if (journal.getMapPath() == compactingMapPath) {
+                if (result.success) {
+                    journal.finishCompaction();
+                } else {
+                    journal.abortCompaction();
                 }
             }
+            compactingMapPath.clear();
         }
 
-        mapJson["tiles"] = tilesJson;
+        if (result.success) {
+            std::cout << "Map saved to " << result.filename << " in " << result.seconds * 1000.0 << " ms" << std::endl;
+            saveStatus = "Saved " + result.filename;
+        } else {
+            saveStatus = "Save failed: " + result.filename;
+        }
+        saveStatusTime = SDL_GetTicks();
+    }
+}
 
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file for writing: " << filename << std::endl;
+bool MapEditor::loadMap(const std::string& filename) {
+    // The cache picks the .bmap or the .json by itself, so it only stands in
+    // for the file it would have read anyway.
+    std::string mapName = MapCache::getMapName(filename);
+    if (mapCache && !mapName.empty() && MapCache::getMapPath(mapName) == filename) {
+        std::shared_ptr<const MapData> cached = mapCache->get(mapName);
+        if (!cached) {
             return false;
         }
 
-        file << mapJson.dump(4);
-        file.close();
-
-        std::cout << "Map saved to " << filename << std::endl;
+        applyMapData(*cached, filename);
+        std::cout << "Map loaded from " << filename << std::endl;
         return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving map: " << e.what() << std::endl;
+    }
+
+    MapData data;
+    if (!MapSerializer::load(filename, data)) {
         return false;
     }
+    Autotiler::updateMap(data);
+
+    applyMapData(data, filename);
+
+    std::cout << "Map loaded from " << filename << std::endl;
+    return true;
 }
 
-bool MapEditor::loadMap(const std::string& filename) {
-    try {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file for reading: " << filename << std::endl;
-            return false;
+void MapEditor::applyMapData(const MapData& data, const std::string& filename) {
+    int decorationCount = tileMap->getDecorationCount();
+    tileMap->applyMapData(data);
+    unjournaledChanges = false;
+
+    // Undo steps refer to tiles of the previous map, a reload of the same file keeps them
+    // unless its decoration layers changed underneath them.
+    if (filename != loadedMapPath || tileMap->getDecorationCount() != decorationCount) {
+        history.clear();
+    }
+    if (currentLayer == EditorLayer::DECORATION && !tileMap->getDecorationLayer(currentDecoration)) {
+        currentLayer = EditorLayer::OBJECTS;
+        currentDecoration = 0;
+    }
+    loadedMapPath = filename;
+
+    if (journal.getMapPath() != filename || !journal.isOpen()) {
+        journal.open(filename);
+    }
+}
+
+void MapEditor::refreshMapList() {
+    mapIndexer.requestScan();
+}
+
+std::string MapEditor::getMapPath(const std::string& mapName) {
+    return "maps/" + mapName + ".json";
+}
+
+SDL_Texture* MapEditor::getThumbnailTexture(const MapIndexEntry& entry) {
+    if (!sdlRenderer || !entry.thumbnail || entry.thumbnailWidth <= 0 || entry.thumbnailHeight <= 0) {
+        return nullptr;
+    }
+
+    auto it = thumbnailTextures.find(entry.name);
+    if (it != thumbnailTextures.end()) {
+        if (it->second.modifiedTime == entry.modifiedTime) {
+            return it->second.texture;
         }
+        SDL_DestroyTexture(it->second.texture);
+        thumbnailTextures.erase(it);
+    }
 
-        nlohmann::json mapJson;
-        file >> mapJson;
-        file.close();
+    SDL_Texture* texture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC,
+                                             entry.thumbnailWidth, entry.thumbnailHeight);
+    if (!texture) {
+        std::cerr << "Failed to create thumbnail for " << entry.name << ": " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
 
-        if (!mapJson.contains("width") || !mapJson.contains("height") ||
-            !mapJson.contains("tileSize") || !mapJson.contains("tiles")) {
-            std::cerr << "Invalid map file format" << std::endl;
-            return false;
+    SDL_UpdateTexture(texture, nullptr, entry.thumbnail->data(), entry.thumbnailWidth * sizeof(uint32_t));
+    thumbnailTextures[entry.name] = {texture, entry.modifiedTime};
+    return texture;
+}
+
+void MapEditor::releaseTextures() {
+    clearThumbnailTextures();
+    minimap.destroy();
+}
+
+void MapEditor::renderMinimap() {
+    if (!minimap.getTexture()) return;
+
+    const float scale = 4.0f;
+    ImVec2 size(minimap.getWidth() * scale, minimap.getHeight() * scale);
+
+    ImGui::SetNextWindowPos(ImVec2(800, 650), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Minimap", &showMinimap, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::Image(reinterpret_cast<ImTextureID>(minimap.getTexture()), size);
+
+        // Clicking or dragging on the image pans the map view there.
+        if (ImGui::IsItemHovered() && ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+            ImVec2 mouse = ImGui::GetMousePos();
+            minimap.panTo((mouse.x - origin.x) / size.x, (mouse.y - origin.y) / size.y);
         }
 
-        for (int y = 0; y < tileMap->getGridHeight(); y++) {
-            for (int x = 0; x < tileMap->getGridWidth(); x++) {
-                Tile* tile = tileMap->getTileAt(x, y);
-                if (tile) {
-                    tile->setProperty("walkable", true);
-                    tile->setProperty("textureID", "");
-                    tile->setProperty("objectTexture", "");
-                }
-            }
+        float texelsPerPixel = scale / tileMap->getTileSize();
+        ImVec2 viewMin(origin.x + tileMap->getViewX() * texelsPerPixel, origin.y + tileMap->getViewY() * texelsPerPixel);
+        ImVec2 viewMax(std::min(origin.x + size.x, viewMin.x + tileMap->getViewWidth() * texelsPerPixel),
+                       std::min(origin.y + size.y, viewMin.y + tileMap->getViewHeight() * texelsPerPixel));
+        ImGui::GetWindowDrawList()->AddRect(viewMin, viewMax, IM_COL32(255, 255, 255, 255));
+    }
+    ImGui::End();
+}
+
+void MapEditor::clearThumbnailTextures() {
+    for (auto& pair : thumbnailTextures) {
+        SDL_DestroyTexture(pair.second.texture);
+    }
+    thumbnailTextures.clear();
+}
+
+uint16_t MapEditor::getLayerValue(int gridX, int gridY, EditLayer layer) {
+    if (!tileMap->isValidGridPosition(gridX, gridY)) return 0;
+
+    switch (layer) {
+        case EditLayer::GROUND:
+            return history.internTexture(tileMap->getGroundTexture(gridX, gridY));
+        case EditLayer::OBJECTS:
+            return history.internTexture(tileMap->getObjectTexture(gridX, gridY));
+        case EditLayer::WALKABLE:
+            return tileMap->isWalkable(gridX, gridY) ? 1 : 0;
+        default:
+            break;
+    }
+
+    TileLayer* decoration = tileMap->getDecorationLayer(getDecorationIndex(layer));
+    return decoration ? history.internTexture(tileMap->getTexture(decoration->get(gridX, gridY))) : 0;
+}
+
+void MapEditor::setLayerValue(int gridX, int gridY, EditLayer layer, uint16_t value) {
+    if (!tileMap->isValidGridPosition(gridX, gridY)) return;
+
+    switch (layer) {
+        case EditLayer::GROUND:
+            tileMap->setTileTexture(gridX, gridY, history.getTexture(value));
+            return;
+        case EditLayer::OBJECTS:
+            tileMap->setObjectTexture(gridX, gridY, history.getTexture(value));
+            return;
+        case EditLayer::WALKABLE:
+            tileMap->setWalkable(gridX, gridY, value != 0);
+            return;
+        default:
+            break;
+    }
+
+    TileLayer* decoration = tileMap->getDecorationLayer(getDecorationIndex(layer));
+    if (decoration) {
+        tileMap->setCell(decoration, gridX, gridY, tileMap->internTexture(history.getTexture(value)));
+        unjournaledChanges = true;
+    }
+}
+
+bool MapEditor::editTile(int gridX, int gridY, EditLayer layer, uint16_t value) {
+    if (!tileMap->isValidGridPosition(gridX, gridY)) return false;
+
+    // Edits outside a stroke (property panel) become their own transaction.
+    bool standalone = !history.isRecording();
+    if (standalone) history.begin();
+
+    bool changed = recordTileValue(gridX, gridY, layer, value);
+
+    if (changed && tileMap->isAutotiled() && (layer == EditLayer::GROUND || layer == EditLayer::OBJECTS)) {
+        if (deferAutotile) {
+            autotileMinX = std::min(autotileMinX, gridX);
+            autotileMinY = std::min(autotileMinY, gridY);
+            autotileMaxX = std::max(autotileMaxX, gridX);
+            autotileMaxY = std::max(autotileMaxY, gridY);
+        } else {
+            EditorAutotileGrid grid(*this);
+            Autotiler::updateRegion(grid, gridX, gridY, gridX, gridY);
         }
+    }
+
+    if (standalone) history.commit();
+    return changed;
+}
 
-        for (const auto& tileJson : mapJson["tiles"]) {
-            int x = tileJson["x"];
-            int y = tileJson["y"];
+bool MapEditor::recordTileValue(int gridX, int gridY, EditLayer layer, uint16_t value) {
+    uint16_t before = getLayerValue(gridX, gridY, layer);
+    if (before == value) return false;
 
-            if (tileMap->isValidGridPosition(x, y)) {
-                Tile* tile = tileMap->getTileAt(x, y);
-                if (tile) {
-                    if (tileJson.contains("walkable")) {
-                        tile->setProperty("walkable", tileJson["walkable"].get<bool>());
-                    }
+    setLayerValue(gridX, gridY, layer, value);
+    history.record(gridY * tileMap->getGridWidth() + gridX, layer, before, value);
+    journalTile(gridX, gridY);
+    return true;
+}
 
-                    if (tileJson.contains("textureID")) {
-                        std::string textureID = tileJson["textureID"].get<std::string>();
-                        tileMap->setTileTexture(x, y, textureID);
-                    }
+void MapEditor::beginShapeEdit() {
+    deferAutotile = true;
+    autotileMinX = tileMap->getGridWidth();
+    autotileMinY = tileMap->getGridHeight();
+    autotileMaxX = -1;
+    autotileMaxY = -1;
+}
 
-                    if (tileJson.contains("objectTexture")) {
-                        std::string objectTexture = tileJson["objectTexture"].get<std::string>();
-                        tile->setProperty("objectTexture", objectTexture);
-                    }
-                }
-            }
+void MapEditor::endShapeEdit() {
+    deferAutotile = false;
+
+    if (autotileMaxX >= autotileMinX && autotileMaxY >= autotileMinY) {
+        EditorAutotileGrid grid(*this);
+        Autotiler::updateRegion(grid, autotileMinX, autotileMinY, autotileMaxX, autotileMaxY);
+    }
+}
+
+void MapEditor::setAutotile(bool enabled) {
+    tileMap->setAutotiled(enabled);
+    unjournaledChanges = true;
+    if (!enabled) return;
+
+    bool standalone = !history.isRecording();
+    if (standalone) history.begin();
+
+    EditorAutotileGrid grid(*this);
+    int changed = Autotiler::updateAll(grid);
+
+    if (standalone) history.commit();
+
+    std::cout << "Autotiling re-picked " << changed << " border tiles" << std::endl;
+}
+
+void MapEditor::applyEdits(const std::vector<TileEdit>& edits) {
+    int width = tileMap->getGridWidth();
+
+    for (const auto& edit : edits) {
+        int x = edit.getTileIndex() % width;
+        int y = edit.getTileIndex() / width;
+
+        setLayerValue(x, y, edit.getLayer(), edit.after);
+        journalTile(x, y);
+    }
+}
+
+void MapEditor::undo() {
+    std::vector<TileEdit> edits;
+    std::vector<ChunkEdit> chunks;
+    if (history.undo(edits, chunks)) {
+        applyEdits(edits);
+        for (const auto& chunk : chunks) {
+            applyChunk(chunk.x, chunk.y, *chunk.after);
         }
+    }
+}
 
-        std::cout << "Map loaded from " << filename << std::endl;
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading map: " << e.what() << std::endl;
-        return false;
+void MapEditor::redo() {
+    std::vector<TileEdit> edits;
+    std::vector<ChunkEdit> chunks;
+    if (history.redo(edits, chunks)) {
+        for (const auto& chunk : chunks) {
+            applyChunk(chunk.x, chunk.y, *chunk.after);
+        }
+        applyEdits(edits);
     }
 }
 
-void MapEditor::refreshMapList() {
-    scanMapDirectory();
+void MapEditor::selectAll() {
+    if (tileMap->getGridWidth() > 0 && tileMap->getGridHeight() > 0) {
+        hasSelection = true;
+        selectionX = 0;
+        selectionY = 0;
+        selectionWidth = tileMap->getGridWidth();
+        selectionHeight = tileMap->getGridHeight();
+    }
 }
 
-std::string MapEditor::getMapPath(const std::string& mapName) {
-    return "maps/" + mapName + ".json";
+void MapEditor::endStroke() {
+    if (isMouseButtonDown) {
+        isMouseButtonDown = false;
+        history.commit();
+    }
 }
 
-void MapEditor::scanMapDirectory() {
-    availableMaps.clear();
+void MapEditor::requestPlay(int startX, int startY) {
+    // Close an open stroke so the session starts from a committed undo state.
+    endStroke();
 
-    try {
-        std::filesystem::create_directories("maps");
+    playRequested = true;
+    playStartX = tileMap->isValidGridPosition(startX, startY) ? startX : -1;
+    playStartY = tileMap->isValidGridPosition(startX, startY) ? startY : -1;
+}
 
-        for (const auto& entry : std::filesystem::directory_iterator("maps")) {
-            if (entry.path().extension() == ".json") {
-                std::string filename = entry.path().stem().string();
-                availableMaps.push_back(filename);
+bool MapEditor::popPlayRequest(int& startX, int& startY) {
+    if (!playRequested) return false;
+
+    playRequested = false;
+    startX = playStartX;
+    startY = playStartY;
+    return true;
+}
+
+MapChunk MapEditor::copyRegion(int x, int y, int width, int height) const {
+    std::shared_ptr<MapData> chunk = std::make_shared<MapData>();
+    tileMap->copyRegion(x, y, width, height, *chunk);
+    return chunk;
+}
+
+void MapEditor::applyChunk(int x, int y, const MapData& chunk) {
+    tileMap->pasteRegion(x, y, chunk);
+    if (!chunk.decorations.empty()) {
+        unjournaledChanges = true;
+    }
+
+    for (int row = 0; row < chunk.height; row++) {
+        for (int column = 0; column < chunk.width; column++) {
+            if (tileMap->isValidGridPosition(x + column, y + row)) {
+                journalTile(x + column, y + row);
             }
         }
+    }
+}
+
+void MapEditor::placeChunk(int x, int y, const MapChunk& chunk) {
+    if (!chunk || !tileMap->isValidGridPosition(x, y)) return;
 
-        if (availableMaps.empty()) {
-            availableMaps.push_back("default");
-            availableMaps.push_back("city");
-            availableMaps.push_back("arena");
+    // Undo can't take layers away again, so they have to exist already.
+    for (const auto& decoration : chunk->decorations) {
+        if (!tileMap->findDecorationLayer(decoration.name)) {
+            saveStatus = "Add decoration layer '" + decoration.name + "' before placing this";
+            saveStatusTime = SDL_GetTicks();
+            return;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error scanning maps directory: " << e.what() << std::endl;
-        availableMaps.push_back("default");
-        availableMaps.push_back("city");
-        availableMaps.push_back("arena");
     }
+
+    bool standalone = !history.isRecording();
+    if (standalone) history.begin();
+
+    // Only the overwritten tiles are copied, the placed chunk itself is shared.
+    MapChunk before = copyRegion(x, y, chunk->width, chunk->height);
+    applyChunk(x, y, *chunk);
+    history.recordChunk(x, y, before, chunk);
+
+    if (tileMap->isAutotiled()) {
+        EditorAutotileGrid grid(*this);
+        Autotiler::updateRegion(grid, x, y, x + chunk->width - 1, y + chunk->height - 1);
+    }
+
+    if (standalone) history.commit();
 }
 
-void MapEditor::recordAction(const TileAction& action) {
-    undoStack.push_back(action);
-    redoStack.clear();
+void MapEditor::copySelection() {
+    if (!hasSelection) return;
+
+    clipboard = copyRegion(selectionX, selectionY, selectionWidth, selectionHeight);
+    saveStatus = "Copied " + std::to_string(selectionWidth) + "x" + std::to_string(selectionHeight) + " tiles";
+    saveStatusTime = SDL_GetTicks();
 }
 
-void MapEditor::undo() {
-    if (undoStack.empty()) return;
+void MapEditor::cutSelection() {
+    endStroke();
+    copySelection();
+    deleteSelection();
+}
 
-    TileAction action = undoStack.back();
-    undoStack.pop_back();
+void MapEditor::deleteSelection() {
+    if (!hasSelection) return;
 
-    TileAction redoAction = action;
-    std::swap(redoAction.oldTextureID, redoAction.newTextureID);
-    std::swap(redoAction.oldWalkable, redoAction.newWalkable);
-    std::swap(redoAction.oldObjectTexture, redoAction.newObjectTexture);
-    redoStack.push_back(redoAction);
+    // A separate undo step from a stroke still in progress.
+    endStroke();
 
-    Tile* tile = tileMap->getTileAt(action.gridX, action.gridY);
-    if (tile) {
-        switch (action.layer) {
-            case EditorLayer::GROUND:
-                tileMap->setTileTexture(action.gridX, action.gridY, action.oldTextureID);
-                break;
-            case EditorLayer::OBJECTS:
-                tile->setProperty("objectTexture", action.oldObjectTexture);
-                break;
-            case EditorLayer::COLLISION:
-                tile->setProperty("walkable", action.oldWalkable);
-                break;
-        }
+    // A blank chunk of the selection size, MapData defaults to empty walkable tiles.
+    std::shared_ptr<MapData> blank = std::make_shared<MapData>();
+    blank->tileSize = tileMap->getTileSize();
+    for (int i = 0; i < tileMap->getDecorationCount(); i++) {
+        blank->decorations.push_back({tileMap->getDecorationLayer(i)->getName(), {}});
     }
+    blank->resize(selectionWidth, selectionHeight);
+
+    placeChunk(selectionX, selectionY, blank);
 }
 
-void MapEditor::redo() {
-    if (redoStack.empty()) return;
+void MapEditor::pasteClipboard() {
+    if (!clipboard) return;
+
+    endStroke();
+
+    activeStamp = clipboard;
+    activeStampName.clear();
+    currentTool = EditorTool::STAMP;
+}
+
+void MapEditor::renderStampPreview(Renderer& renderer) {
+    if (!activeStamp || !tileMap->isValidGridPosition(gridX, gridY)) return;
 
-    TileAction action = redoStack.back();
-    redoStack.pop_back();
+    int tileSize = tileMap->getTileSize();
+    for (int row = 0; row < activeStamp->height; row++) {
+        for (int column = 0; column < activeStamp->width; column++) {
+            if (!tileMap->isValidGridPosition(gridX + column, gridY + row)) continue;
 
-    TileAction undoAction = action;
-    std::swap(undoAction.oldTextureID, undoAction.newTextureID);
-    std::swap(undoAction.oldWalkable, undoAction.newWalkable);
-    std::swap(undoAction.oldObjectTexture, undoAction.newObjectTexture);
-    undoStack.push_back(undoAction);
+            int i = activeStamp->index(column, row);
+            int pixelX = (gridX + column) * tileSize;
+            int pixelY = (gridY + row) * tileSize;
 
-    Tile* tile = tileMap->getTileAt(action.gridX, action.gridY);
-    if (tile) {
-        switch (action.layer) {
-            case EditorLayer::GROUND:
-                tileMap->setTileTexture(action.gridX, action.gridY, action.newTextureID);
-                break;
-            case EditorLayer::OBJECTS:
-                tile->setProperty("objectTexture", action.newObjectTexture);
-                break;
-            case EditorLayer::COLLISION:
-                tile->setProperty("walkable", action.newWalkable);
-                break;
+            const std::string& ground = activeStamp->getTexture(activeStamp->ground[i]);
+            if (!ground.empty()) {
+                renderer.renderTexture(ground, pixelX, pixelY, tileSize, tileSize);
+            }
+
+            const std::string& object = activeStamp->getTexture(activeStamp->objects[i]);
+            if (!object.empty()) {
+                renderer.renderTexture(object, pixelX, pixelY, tileSize, tileSize);
+            }
         }
     }
+
+    renderer.setDrawColor(
+        static_cast<Uint8>(cursorColor.x * 255),
+        static_cast<Uint8>(cursorColor.y * 255),
+        static_cast<Uint8>(cursorColor.z * 255),
+        static_cast<Uint8>(cursorColor.w * 255));
+    renderer.drawRect(gridX * tileSize, gridY * tileSize, activeStamp->width * tileSize, activeStamp->height * tileSize);
 }
 
-void MapEditor::selectAll() {
-    if (tileMap->getGridWidth() > 0 && tileMap->getGridHeight() > 0) {
-        selectedTileX = 0;
-        selectedTileY = 0;
-        hasTileSelected = true;
-        showPropertyPanel = true;
+void MapEditor::renderStampLibrary() {
+    ImGui::SetNextWindowPos(ImVec2(800, 330), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(200, 300), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Stamp Library", &showStampLibrary)) {
+        if (clipboard && ImGui::Selectable("(Clipboard)", activeStamp == clipboard && activeStampName.empty())) {
+            pasteClipboard();
+        }
+
+        std::string removedStamp;
+        for (const auto& entry : stampLibrary.getStamps()) {
+            std::string label = entry.first + " (" + std::to_string(entry.second->width) + "x" +
+                                std::to_string(entry.second->height) + ")";
+
+            if (ImGui::Selectable(label.c_str(), activeStampName == entry.first)) {
+                activeStamp = entry.second;
+                activeStampName = entry.first;
+                currentTool = EditorTool::STAMP;
+            }
+
+            if (ImGui::BeginPopupContextItem(entry.first.c_str())) {
+                if (ImGui::MenuItem("Delete")) {
+                    removedStamp = entry.first;
+                }
+                ImGui::EndPopup();
+            }
+        }
+
+        if (!removedStamp.empty()) {
+            if (activeStampName == removedStamp) {
+                activeStamp = nullptr;
+                activeStampName.clear();
+            }
+            stampLibrary.removeStamp(removedStamp);
+        }
+
+        ImGui::Separator();
+
+        ImGui::InputText("Name", stampNameBuffer, sizeof(stampNameBuffer));
+        if (ImGui::Button("Save Selection", ImVec2(150, 0)) && hasSelection && strlen(stampNameBuffer) > 0) {
+            MapChunk stamp = copyRegion(selectionX, selectionY, selectionWidth, selectionHeight);
+            if (stampLibrary.addStamp(stampNameBuffer, stamp)) {
+                activeStamp = stamp;
+                activeStampName = stampNameBuffer;
+            }
+        }
     }
+    ImGui::End();
 }
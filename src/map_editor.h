@@ -3,21 +3,36 @@
 
 #include <SDL2/SDL.h>
 #include <vector>
+#include <map>
 #include <string>
 #include "tilemap.h"
 #include "renderer.h"
+#include "map_cache.h"
+#include "map_saver.h"
+#include "map_journal.h"
+#include "edit_history.h"
+#include "autotile.h"
+#include "stamp_library.h"
+#include "map_indexer.h"
+#include "minimap.h"
 #include "imgui/imgui.h"
 
 enum class EditorTool {
     PENCIL,
     ERASER,
-    PROPERTY_EDITOR
+    PROPERTY_EDITOR,
+    FILL,
+    RECTANGLE,
+    LINE,
+    SELECT,
+    STAMP
 };
 
 enum class EditorLayer {
     GROUND,
     OBJECTS,
-    COLLISION
+    COLLISION,
+    DECORATION
 };
 
 struct TileTexture {
@@ -42,15 +57,42 @@ public:
     bool loadMap(const std::string& filename);
     bool saveMap(const std::string& filename);
 
+    void setHistoryLimit(size_t bytes) { history.setMemoryLimit(bytes); }
+
+    // Swaps already parsed map data into the live TileMap.
+    void applyMapData(const MapData& data, const std::string& filename);
+    const std::string& getLoadedMapPath() const { return loadedMapPath; }
+    bool isOwnSave(const std::string& filename, std::filesystem::file_time_type writeTime) const {
+        return mapSaver.isOwnWrite(filename, writeTime);
+    }
+
+    void setMapCache(MapCache* cache) { mapCache = cache; }
+
+    TileMap* getTileMap() const { return tileMap; }
+
+    // Frees SDL textures, must run before the SDL renderer is destroyed.
+    void releaseTextures();
+
+    // Set by "Play Here", the game picks it up and starts a play session from
+    // the live map. The start tile is -1 when no tile was chosen.
+    bool popPlayRequest(int& startX, int& startY);
+
 private:
     TileMap* tileMap;
+    MapCache* mapCache;
     bool active;
     int mouseX, mouseY;
     int gridX, gridY;
     EditorTool currentTool;
     EditorLayer currentLayer;
+    int currentDecoration;
     int currentTileIndex;
 
+    // Position of the edited layer in TileMap::getLayers().
+    int getCurrentLayerIndex() const;
+    void selectLayerIndex(int index);
+    char decorationNameBuffer[32];
+
     std::vector<TileTexture> availableTiles;
 
     SDL_Rect paletteArea;
@@ -60,6 +102,12 @@ private:
 
     bool showPropertyPanel;
     std::string editingProperty;
+
+    bool playRequested;
+    int playStartX, playStartY;
+    void requestPlay(int startX, int startY);
+    // Commits the transaction of a stroke the mouse is still drawing.
+    void endStroke();
     bool editingPropertyValue;
 
     void initializeAvailableTiles();
@@ -73,10 +121,62 @@ private:
 
     void applyTileAtPosition(int gridX, int gridY);
     void eraseTileAtPosition(int gridX, int gridY);
+
+    // Layer and value the current tool writes, erasing clears textures and makes tiles walkable.
+    bool getBrushValue(bool erase, EditLayer& layer, uint16_t& value);
+    void paintLine(int startX, int startY, int endX, int endY, bool erase);
+    void fillRectangle(int startX, int startY, int endX, int endY);
+    void floodFill(int startX, int startY);
+    static void traceLine(int startX, int startY, int endX, int endY, std::vector<std::pair<int, int>>& cells);
+
+    int dragStartX, dragStartY;
+    int lastPaintX, lastPaintY;
+
+    // Border tiles around each edit are re-evaluated right away, shape tools
+    // collect the touched area and re-evaluate it once at the end.
+    friend class EditorAutotileGrid;
+    bool deferAutotile;
+    int autotileMinX, autotileMinY, autotileMaxX, autotileMaxY;
+    void beginShapeEdit();
+    void endShapeEdit();
+    // Turning it on re-picks every border tile once, as one undo step.
+    void setAutotile(bool enabled);
     void openPropertyEditor(int gridX, int gridY);
 
     std::string currentMapName;
-    std::vector<std::string> availableMaps;
+    std::string loadedMapPath;
+
+    MapSaver mapSaver;
+    std::string saveStatus;
+    Uint32 saveStatusTime;
+    void processSaveResults();
+
+    // Edits go to the journal as they happen, the base file is only rewritten
+    // when the journal grows past this many records or on save-as.
+    static const int JOURNAL_COMPACT_RECORDS = 4096;
+    MapJournal journal;
+    // The journal only records ground, objects and walkable, any decoration
+    // or autotile setting change makes the next save a full one.
+    bool unjournaledChanges;
+    std::string compactingMapPath;
+    void journalTile(int gridX, int gridY);
+    void queueFullSave(const std::string& filename, const std::shared_ptr<const MapData>& data);
+    // The browser lists whatever the indexer has published, thumbnail textures
+    // are only created for rows that scroll into view.
+    struct MapThumbnail {
+        SDL_Texture* texture;
+        int64_t modifiedTime;
+    };
+    MapIndexer mapIndexer;
+    std::map<std::string, MapThumbnail> thumbnailTextures;
+    SDL_Renderer* sdlRenderer;
+    SDL_Texture* getThumbnailTexture(const MapIndexEntry& entry);
+    void clearThumbnailTextures();
+
+    Minimap minimap;
+    bool showMinimap;
+    void renderMinimap();
+
     bool showMapBrowser;
     char inputMapNameBuffer[256];
     bool isNamingMap;
@@ -84,7 +184,6 @@ private:
 
     void refreshMapList();
     std::string getMapPath(const std::string& mapName);
-    void scanMapDirectory();
 
     int selectedTileX;
     int selectedTileY;
@@ -101,24 +200,41 @@ private:
     bool isMouseButtonDown;
     bool isCtrlPressed;
 
-    struct TileAction {
-        int gridX, gridY;
-        EditorLayer layer;
-        std::string oldTextureID;
-        std::string newTextureID;
-        bool oldWalkable;
-        bool newWalkable;
-        std::string oldObjectTexture;
-        std::string newObjectTexture;
-    };
+    EditHistory history;
 
-    std::vector<TileAction> undoStack;
-    std::vector<TileAction> redoStack;
+    // Reads and writes one tile layer in history values (texture index or walkable 0/1).
+    uint16_t getLayerValue(int gridX, int gridY, EditLayer layer);
+    void setLayerValue(int gridX, int gridY, EditLayer layer, uint16_t value);
+    bool editTile(int gridX, int gridY, EditLayer layer, uint16_t value);
+    bool recordTileValue(int gridX, int gridY, EditLayer layer, uint16_t value);
+    void applyEdits(const std::vector<TileEdit>& edits);
 
-    void recordAction(const TileAction& action);
     void undo();
     void redo();
     void selectAll();
+
+    bool hasSelection;
+    int selectionX, selectionY;
+    int selectionWidth, selectionHeight;
+
+    // The clipboard and the stamp being placed point at the same immutable
+    // chunks as the library and the undo history.
+    MapChunk clipboard;
+    MapChunk activeStamp;
+    std::string activeStampName;
+    StampLibrary stampLibrary;
+    bool showStampLibrary;
+    char stampNameBuffer[64];
+
+    MapChunk copyRegion(int x, int y, int width, int height) const;
+    void applyChunk(int x, int y, const MapData& chunk);
+    void placeChunk(int x, int y, const MapChunk& chunk);
+    void copySelection();
+    void cutSelection();
+    void deleteSelection();
+    void pasteClipboard();
+    void renderStampLibrary();
+    void renderStampPreview(Renderer& renderer);
 };
 
 #endif // MAP_EDITOR_H
\ No newline at end of file
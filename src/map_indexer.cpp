@@ -0,0 +1,308 @@
+#include "map_indexer.h"
+#include "map_serializer.h"
+#include "map_journal.h"
+#include "atomic_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+uint32_t packColor(uint8_t r, uint8_t g, uint8_t b) {
+    return 0xFF000000u | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(g) << 8) | r;
+}
+
+int64_t getWriteTime(const std::string& path) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    if (error) return 0;
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+}
+
+MapIndexer::MapIndexer() : stopping(false), scanRequested(false), scanning(false),
+                           snapshot(std::make_shared<const MapIndex>()) {
+}
+
+MapIndexer::~MapIndexer() {
+    shutdown();
+}
+
+void MapIndexer::start(const std::string& mapDirectory, const std::string& cacheDirectory) {
+    if (worker.joinable()) return;
+
+    this->mapDirectory = mapDirectory;
+    this->cacheDirectory = cacheDirectory;
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    stopping = false;
+    worker = std::thread(&MapIndexer::workerLoop, this);
+}
+
+void MapIndexer::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    scanCondition.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void MapIndexer::requestScan() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scanRequested = true;
+    }
+    scanCondition.notify_one();
+}
+
+bool MapIndexer::isScanning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scanning || scanRequested;
+}
+
+std::shared_ptr<const MapIndex> MapIndexer::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return snapshot;
+}
+
+void MapIndexer::workerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            scanCondition.wait(lock, [this]() { return stopping || scanRequested; });
+
+            if (stopping) return;
+
+            scanRequested = false;
+            scanning = true;
+        }
+
+        scan();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        scanning = false;
+    }
+}
+
+void MapIndexer::scan() {
+    std::map<std::string, MapIndexEntry> found;
+
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(mapDirectory, error)) {
+        std::string extension = file.path().extension().string();
+        if (extension != ".json" && extension != ".bmap") continue;
+
+        // JSON is what the editor opens, a .bmap on its own is still listed.
+        MapIndexEntry& entry = found[file.path().stem().string()];
+        if (extension == ".json" || entry.path.empty()) {
+            entry.name = file.path().stem().string();
+            entry.path = file.path().string();
+        }
+    }
+
+    if (error) {
+        std::cerr << "Error scanning " << mapDirectory << ": " << error.message() << std::endl;
+    }
+
+    for (auto& pair : found) {
+        MapIndexEntry& entry = pair.second;
+        entry.modifiedTime = std::max(getWriteTime(entry.path), getWriteTime(MapJournal::getJournalPath(entry.path)));
+
+        std::error_code sizeError;
+        uintmax_t size = std::filesystem::file_size(entry.path, sizeError);
+        entry.fileSize = sizeError ? 0 : static_cast<uint64_t>(size);
+
+        auto it = known.find(pair.first);
+        if (it != known.end() && it->second.indexed && it->second.path == entry.path &&
+            it->second.modifiedTime == entry.modifiedTime && it->second.fileSize == entry.fileSize) {
+            entry = it->second;
+        }
+    }
+
+    // Names go out straight away, details follow as they are read.
+    known.swap(found);
+    publish();
+
+    auto lastPublish = std::chrono::steady_clock::now();
+    for (auto& pair : known) {
+        if (pair.second.indexed) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || scanRequested) break;
+        }
+
+        indexEntry(pair.second);
+
+        if (std::chrono::steady_clock::now() - lastPublish > std::chrono::milliseconds(100)) {
+            publish();
+            lastPublish = std::chrono::steady_clock::now();
+        }
+    }
+
+    publish();
+}
+
+void MapIndexer::publish() {
+    std::shared_ptr<MapIndex> index = std::make_shared<MapIndex>();
+    index->reserve(known.size());
+    for (const auto& pair : known) {
+        index->push_back(pair.second);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshot = index;
+}
+
+void MapIndexer::indexEntry(MapIndexEntry& entry) {
+    entry.indexed = true;
+
+    if (loadCachedEntry(entry)) return;
+
+    MapData data;
+    if (!MapSerializer::load(entry.path, data)) {
+        entry.failed = true;
+        return;
+    }
+
+    buildEntry(data, entry);
+    saveCachedEntry(entry);
+}
+
+void MapIndexer::buildEntry(const MapData& data, MapIndexEntry& entry) {
+    entry.width = data.width;
+    entry.height = data.height;
+    entry.groundTiles = 0;
+    entry.objectTiles = 0;
+    entry.walkableTiles = 0;
+
+    size_t count = static_cast<size_t>(data.width) * data.height;
+    for (size_t i = 0; i < count; i++) {
+        if (data.ground[i] != 0) entry.groundTiles++;
+        if (data.objects[i] != 0) entry.objectTiles++;
+        if (data.walkable[i]) entry.walkableTiles++;
+    }
+
+    // Colours are looked up once per palette entry, not per tile.
+    std::vector<uint32_t> colors(data.palette.size());
+    for (size_t i = 0; i < data.palette.size(); i++) {
+        colors[i] = getThumbnailColor(data.palette[i]);
+    }
+
+    int longestSide = std::max(data.width, data.height);
+    int scale = std::max(1, (longestSide + MAP_THUMBNAIL_SIZE - 1) / MAP_THUMBNAIL_SIZE);
+    entry.thumbnailWidth = (data.width + scale - 1) / scale;
+    entry.thumbnailHeight = (data.height + scale - 1) / scale;
+
+    std::shared_ptr<std::vector<uint32_t>> pixels =
+        std::make_shared<std::vector<uint32_t>>(static_cast<size_t>(entry.thumbnailWidth) * entry.thumbnailHeight);
+
+    for (int y = 0; y < entry.thumbnailHeight; y++) {
+        for (int x = 0; x < entry.thumbnailWidth; x++) {
+            int tileX = std::min(x * scale + scale / 2, data.width - 1);
+            int tileY = std::min(y * scale + scale / 2, data.height - 1);
+            int i = data.index(tileX, tileY);
+
+            uint16_t value = data.objects[i] != 0 ? data.objects[i] : data.ground[i];
+            uint32_t color = value < colors.size() ? colors[value] : colors[0];
+
+            // Blocked tiles are drawn at half brightness.
+            if (!data.walkable[i]) {
+                color = 0xFF000000u | ((color >> 1) & 0x007F7F7Fu);
+            }
+
+            (*pixels)[static_cast<size_t>(y) * entry.thumbnailWidth + x] = color;
+        }
+    }
+
+    entry.thumbnail = pixels;
+}
+
+uint32_t MapIndexer::getThumbnailColor(const std::string& textureID) {
+    static const std::map<std::string, uint32_t> colors = {
+        {"", packColor(40, 40, 40)},
+        {"tile_grass", packColor(86, 152, 62)},
+        {"tile_wall", packColor(120, 120, 128)},
+        {"border_grass", packColor(54, 110, 40)},
+        {"border_path", packColor(168, 132, 86)},
+        {"border_water", packColor(58, 108, 180)},
+        {"border1", packColor(96, 130, 70)},
+        {"border2", packColor(76, 116, 56)},
+        {"base_limit", packColor(20, 20, 24)}
+    };
+
+    auto it = colors.find(textureID);
+    if (it != colors.end()) {
+        return it->second;
+    }
+
+    // Unknown textures still get a stable colour so different ones stay distinguishable.
+    uint32_t hash = 2166136261u;
+    for (char c : textureID) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return packColor(64 + (hash & 0x7F), 64 + ((hash >> 8) & 0x7F), 64 + ((hash >> 16) & 0x7F));
+}
+
+std::string MapIndexer::getCachePath(const std::string& name) const {
+    return cacheDirectory + "/" + name + ".index";
+}
+
+bool MapIndexer::loadCachedEntry(MapIndexEntry& entry) const {
+    std::ifstream file(getCachePath(entry.name), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    MapIndexHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+    if (memcmp(header.magic, MAP_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != MAP_INDEX_VERSION ||
+        header.modifiedTime != entry.modifiedTime || header.fileSize != entry.fileSize ||
+        header.thumbnailWidth > MAP_THUMBNAIL_SIZE || header.thumbnailHeight > MAP_THUMBNAIL_SIZE) {
+        return false;
+    }
+
+    std::shared_ptr<std::vector<uint32_t>> pixels =
+        std::make_shared<std::vector<uint32_t>>(static_cast<size_t>(header.thumbnailWidth) * header.thumbnailHeight);
+    if (!file.read(reinterpret_cast<char*>(pixels->data()), pixels->size() * sizeof(uint32_t))) return false;
+
+    entry.width = static_cast<int>(header.width);
+    entry.height = static_cast<int>(header.height);
+    entry.groundTiles = static_cast<int>(header.groundTiles);
+    entry.objectTiles = static_cast<int>(header.objectTiles);
+    entry.walkableTiles = static_cast<int>(header.walkableTiles);
+    entry.thumbnailWidth = static_cast<int>(header.thumbnailWidth);
+    entry.thumbnailHeight = static_cast<int>(header.thumbnailHeight);
+    entry.thumbnail = pixels;
+    return true;
+}
+
+void MapIndexer::saveCachedEntry(const MapIndexEntry& entry) const {
+    MapIndexHeader header = {};
+    memcpy(header.magic, MAP_INDEX_MAGIC, sizeof(header.magic));
+    header.version = MAP_INDEX_VERSION;
+    header.modifiedTime = entry.modifiedTime;
+    header.fileSize = entry.fileSize;
+    header.width = static_cast<uint32_t>(entry.width);
+    header.height = static_cast<uint32_t>(entry.height);
+    header.groundTiles = static_cast<uint32_t>(entry.groundTiles);
+    header.objectTiles = static_cast<uint32_t>(entry.objectTiles);
+    header.walkableTiles = static_cast<uint32_t>(entry.walkableTiles);
+    header.thumbnailWidth = static_cast<uint32_t>(entry.thumbnailWidth);
+    header.thumbnailHeight = static_cast<uint32_t>(entry.thumbnailHeight);
+
+    std::vector<char> buffer(sizeof(header) + entry.thumbnail->size() * sizeof(uint32_t));
+    memcpy(buffer.data(), &header, sizeof(header));
+    memcpy(buffer.data() + sizeof(header), entry.thumbnail->data(), entry.thumbnail->size() * sizeof(uint32_t));
+
+    writeFileAtomic(getCachePath(entry.name), buffer.data(), buffer.size());
+}
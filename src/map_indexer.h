@@ -0,0 +1,110 @@
+#ifndef MAP_INDEXER_H
+#define MAP_INDEXER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "map_data.h"
+
+// Thumbnails are at most this many pixels on their longest side, one pixel per sampled tile.
+const int MAP_THUMBNAIL_SIZE = 64;
+
+// Per-map index entry cache layout (little endian), version 1:
+//   MapIndexHeader
+//   thumbnail: uint32 RGBA[thumbnailWidth * thumbnailHeight]
+const char MAP_INDEX_MAGIC[4] = {'M', 'A', 'D', 'I'};
+const uint32_t MAP_INDEX_VERSION = 1;
+
+struct MapIndexHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t modifiedTime;
+    uint64_t fileSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t groundTiles;
+    uint32_t objectTiles;
+    uint32_t walkableTiles;
+    uint32_t thumbnailWidth;
+    uint32_t thumbnailHeight;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(MapIndexHeader) == 56, "MapIndexHeader layout changed");
+
+struct MapIndexEntry {
+    std::string name;
+    std::string path;
+    // Newest write time of the map and its journal, used as the cache key.
+    int64_t modifiedTime = 0;
+    uint64_t fileSize = 0;
+
+    // Filled in once the map has been read or found in the cache.
+    bool indexed = false;
+    bool failed = false;
+    int width = 0;
+    int height = 0;
+    int groundTiles = 0;
+    int objectTiles = 0;
+    int walkableTiles = 0;
+
+    int thumbnailWidth = 0;
+    int thumbnailHeight = 0;
+    std::shared_ptr<const std::vector<uint32_t>> thumbnail;
+};
+
+typedef std::vector<MapIndexEntry> MapIndex;
+
+// Scans a map directory on a background thread. Each map's metadata and
+// thumbnail are cached in cacheDirectory and only rebuilt when the map's
+// write time changes. The editor reads the published snapshot every frame,
+// entries appear unindexed first and fill in as the worker gets to them.
+class MapIndexer {
+public:
+    MapIndexer();
+    ~MapIndexer();
+
+    void start(const std::string& mapDirectory, const std::string& cacheDirectory);
+    void shutdown();
+
+    void requestScan();
+    bool isScanning() const;
+
+    // Sorted by name. Returns the same pointer until something changes.
+    std::shared_ptr<const MapIndex> getSnapshot() const;
+
+    static uint32_t getThumbnailColor(const std::string& textureID);
+    static void buildEntry(const MapData& data, MapIndexEntry& entry);
+
+private:
+    std::string mapDirectory;
+    std::string cacheDirectory;
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable scanCondition;
+    bool stopping;
+    bool scanRequested;
+    bool scanning;
+
+    std::shared_ptr<const MapIndex> snapshot;
+
+    // Only touched by the worker, keeps indexed entries between scans.
+    std::map<std::string, MapIndexEntry> known;
+
+    void workerLoop();
+    void scan();
+    void publish();
+    void indexEntry(MapIndexEntry& entry);
+
+    std::string getCachePath(const std::string& name) const;
+    bool loadCachedEntry(MapIndexEntry& entry) const;
+    void saveCachedEntry(const MapIndexEntry& entry) const;
+};
+
+#endif // MAP_INDEXER_H
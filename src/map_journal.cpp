@@ -0,0 +1,275 @@
+#include "map_journal.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t JOURNAL_HEADER_SIZE = 8;
+
+uint16_t readU16(const uint8_t* bytes) {
+    uint16_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+void appendU16(std::string& out, uint16_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendU16(out, static_cast<uint16_t>(value.size()));
+    out += value;
+}
+
+std::string readWholeFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+}
+
+MapJournal::MapJournal() : file(nullptr), attached(false), recordCount(0) {
+}
+
+MapJournal::~MapJournal() {
+    close();
+}
+
+bool MapJournal::open(const std::string& newMapPath) {
+    close();
+
+    mapPath = newMapPath;
+    journalPath = getJournalPath(newMapPath);
+    attached = true;
+
+    // Left over from a compaction that never finished, possibly in another session.
+    if (isCompacting()) {
+        foldCompactingFile();
+    }
+
+    // Drop a torn record left by a crash, otherwise new records would land behind it.
+    size_t validSize = 0;
+    recordCount = scanFile(journalPath, nullptr, &validSize);
+
+    std::error_code error;
+    if (validSize >= JOURNAL_HEADER_SIZE && std::filesystem::file_size(journalPath, error) > validSize) {
+        std::filesystem::resize_file(journalPath, validSize, error);
+    }
+
+    if (validSize < JOURNAL_HEADER_SIZE) {
+        return true;
+    }
+    return openFile(false);
+}
+
+void MapJournal::close() {
+    closeFile();
+    attached = false;
+}
+
+void MapJournal::closeFile() {
+    if (file) {
+        std::fflush(file);
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool MapJournal::openFile(bool truncate) {
+    std::error_code error;
+    uintmax_t existingSize = std::filesystem::file_size(journalPath, error);
+    bool fresh = truncate || error || existingSize < JOURNAL_HEADER_SIZE;
+
+    file = std::fopen(journalPath.c_str(), fresh ? "wb" : "ab");
+    if (!file) {
+        std::cerr << "Failed to open map journal: " << journalPath << std::endl;
+        return false;
+    }
+
+    if (fresh) {
+        std::fwrite(MAP_JOURNAL_MAGIC, 1, sizeof(MAP_JOURNAL_MAGIC), file);
+        std::fwrite(&MAP_JOURNAL_VERSION, sizeof(MAP_JOURNAL_VERSION), 1, file);
+        recordCount = 0;
+    }
+    return true;
+}
+
+void MapJournal::appendTile(int x, int y, const std::string& ground, const std::string& objects, bool walkable) {
+    if (!attached) return;
+    if (!file && !openFile(false)) return;
+
+    std::string payload;
+    appendU16(payload, static_cast<uint16_t>(x));
+    appendU16(payload, static_cast<uint16_t>(y));
+    payload += static_cast<char>(walkable ? 1 : 0);
+    appendString(payload, ground);
+    appendString(payload, objects);
+
+    std::string record;
+    appendU16(record, static_cast<uint16_t>(payload.size()));
+    record += payload;
+
+    // Handed to the OS straight away so a crash of the game keeps the edit, sync() makes it durable.
+    std::fwrite(record.data(), 1, record.size(), file);
+    std::fflush(file);
+    recordCount++;
+}
+
+bool MapJournal::sync() {
+    if (!attached) return false;
+    // Nothing was appended yet.
+    if (!file) return true;
+
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool MapJournal::beginCompaction() {
+    if (!file || isCompacting()) return false;
+
+    sync();
+    closeFile();
+
+    std::error_code error;
+    std::filesystem::rename(journalPath, journalPath + ".compacting", error);
+    if (error) {
+        std::cerr << "Failed to rotate map journal: " << error.message() << std::endl;
+        openFile(false);
+        return false;
+    }
+
+    // The next record starts a fresh journal.
+    recordCount = 0;
+    return true;
+}
+
+void MapJournal::finishCompaction() {
+    std::error_code error;
+    std::filesystem::remove(journalPath + ".compacting", error);
+}
+
+void MapJournal::abortCompaction() {
+    if (!isCompacting()) return;
+
+    closeFile();
+    foldCompactingFile();
+
+    recordCount = scanFile(journalPath, nullptr);
+    openFile(false);
+}
+
+void MapJournal::foldCompactingFile() {
+    // The rotated records go back in front of the newer ones, replaying them
+    // again is harmless if the base file was rewritten after all.
+    std::string compactingPath = journalPath + ".compacting";
+
+    size_t validSize = 0;
+    scanFile(compactingPath, nullptr, &validSize);
+
+    std::string merged = readWholeFile(compactingPath);
+    merged.resize(validSize);
+
+    std::string current = readWholeFile(journalPath);
+    if (merged.empty()) {
+        merged = current;
+    } else if (current.size() > JOURNAL_HEADER_SIZE) {
+        merged.append(current, JOURNAL_HEADER_SIZE, std::string::npos);
+    }
+
+    std::ofstream out(journalPath, std::ios::binary | std::ios::trunc);
+    out.write(merged.data(), merged.size());
+    out.close();
+
+    if (out.good()) {
+        finishCompaction();
+    }
+}
+
+bool MapJournal::isCompacting() const {
+    std::error_code error;
+    return !journalPath.empty() && std::filesystem::exists(journalPath + ".compacting", error);
+}
+
+std::string MapJournal::getJournalPath(const std::string& mapPath) {
+    std::filesystem::path path(mapPath);
+    path.replace_extension(".journal");
+    return path.string();
+}
+
+int MapJournal::replay(const std::string& mapPath, MapData& data) {
+    std::string journalPath = getJournalPath(mapPath);
+    return scanFile(journalPath + ".compacting", &data) + scanFile(journalPath, &data);
+}
+
+int MapJournal::scanFile(const std::string& journalPath, MapData* data, size_t* validSize) {
+    if (validSize) *validSize = 0;
+
+    std::error_code error;
+    if (!std::filesystem::exists(journalPath, error)) {
+        return 0;
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(journalPath) || mapped.getSize() < JOURNAL_HEADER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t* bytes = mapped.getData();
+    size_t size = mapped.getSize();
+
+    uint32_t version;
+    std::memcpy(&version, bytes + 4, sizeof(version));
+    if (std::memcmp(bytes, MAP_JOURNAL_MAGIC, sizeof(MAP_JOURNAL_MAGIC)) != 0 || version != MAP_JOURNAL_VERSION) {
+        std::cerr << "Ignoring unrecognized map journal: " << journalPath << std::endl;
+        return 0;
+    }
+
+    int records = 0;
+    size_t offset = JOURNAL_HEADER_SIZE;
+
+    // A record cut short by a crash ends the replay, everything before it is kept.
+    while (offset + 2 <= size) {
+        size_t payloadSize = readU16(bytes + offset);
+        const uint8_t* payload = bytes + offset + 2;
+        if (offset + 2 + payloadSize > size || payloadSize < 9) break;
+
+        int x = readU16(payload);
+        int y = readU16(payload + 2);
+        bool walkable = payload[4] != 0;
+
+        size_t groundLength = readU16(payload + 5);
+        if (7 + groundLength + 2 > payloadSize) break;
+        std::string ground(reinterpret_cast<const char*>(payload + 7), groundLength);
+
+        size_t objectsLength = readU16(payload + 7 + groundLength);
+        if (9 + groundLength + objectsLength > payloadSize) break;
+        std::string objects(reinterpret_cast<const char*>(payload + 9 + groundLength), objectsLength);
+
+        if (data && data->contains(x, y)) {
+            int i = data->index(x, y);
+            data->ground[i] = data->internTexture(ground);
+            data->objects[i] = data->internTexture(objects);
+            data->walkable[i] = walkable ? 1 : 0;
+        }
+
+        records++;
+        offset += 2 + payloadSize;
+    }
+
+    if (validSize) *validSize = offset;
+    return records;
+}
@@ -0,0 +1,63 @@
+#ifndef MAP_JOURNAL_H
+#define MAP_JOURNAL_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include "map_data.h"
+
+// Journal layout: an 8 byte header ("MADJ" + version) followed by records of
+// a uint16 payload size and the payload: uint16 x, uint16 y, uint8 walkable,
+// then the ground and object texture ids as uint16 length + bytes. Every
+// record holds the full state of one tile, so replaying a record twice is
+// harmless.
+const char MAP_JOURNAL_MAGIC[4] = {'M', 'A', 'D', 'J'};
+const uint32_t MAP_JOURNAL_VERSION = 1;
+
+// Append-only log of tile edits kept next to a map file (maps/city.journal
+// for maps/city.json). MapSerializer::load replays it on top of the base
+// snapshot. Compaction moves the log aside as <journal>.compacting while the
+// base file is rewritten, and deletes it once the write has succeeded.
+// The journal file itself is only created by the first appended record, so
+// opening a map without editing it leaves nothing behind.
+class MapJournal {
+public:
+    MapJournal();
+    ~MapJournal();
+
+    bool open(const std::string& mapPath);
+    void close();
+    bool isOpen() const { return attached; }
+
+    void appendTile(int x, int y, const std::string& ground, const std::string& objects, bool walkable);
+    // Pushes appended records to disk, this is what a save costs between compactions.
+    bool sync();
+
+    int getRecordCount() const { return recordCount; }
+    const std::string& getMapPath() const { return mapPath; }
+
+    bool beginCompaction();
+    void finishCompaction();
+    void abortCompaction();
+    bool isCompacting() const;
+
+    static std::string getJournalPath(const std::string& mapPath);
+    // Applies <journal>.compacting and then the journal itself, returns the records applied.
+    static int replay(const std::string& mapPath, MapData& data);
+
+private:
+    std::FILE* file;
+    bool attached;
+    std::string mapPath;
+    std::string journalPath;
+    int recordCount;
+
+    bool openFile(bool truncate);
+    void closeFile();
+    void foldCompactingFile();
+    // Counts the complete records in a journal and applies them to data when given.
+    // validSize receives the length up to the end of the last complete record.
+    static int scanFile(const std::string& journalPath, MapData* data, size_t* validSize = nullptr);
+};
+
+#endif // MAP_JOURNAL_H
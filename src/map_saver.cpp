@@ -0,0 +1,97 @@
+#include "map_saver.h"
+#include "map_serializer.h"
+#include <chrono>
+
+MapSaver::MapSaver() : activeJobs(0), stopping(false) {
+}
+
+MapSaver::~MapSaver() {
+    shutdown();
+}
+
+void MapSaver::start() {
+    if (worker.joinable()) return;
+
+    stopping = false;
+    worker = std::thread(&MapSaver::workerLoop, this);
+}
+
+void MapSaver::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void MapSaver::queueSave(const std::string& filename, std::shared_ptr<const MapData> data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& job : jobs) {
+            if (job.filename == filename) {
+                job.data = data;
+                return;
+            }
+        }
+
+        jobs.push_back({filename, data});
+        activeJobs++;
+    }
+    jobCondition.notify_one();
+}
+
+bool MapSaver::popResult(MapSaveResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) {
+        return false;
+    }
+
+    result = results.front();
+    results.pop_front();
+    return true;
+}
+
+bool MapSaver::isOwnWrite(const std::string& filename, std::filesystem::file_time_type writeTime) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = writtenFiles.find(filename);
+    return it != writtenFiles.end() && it->second == writeTime;
+}
+
+bool MapSaver::isSaving() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return activeJobs > 0;
+}
+
+void MapSaver::workerLoop() {
+    while (true) {
+        SaveJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            // Pending saves are still written on shutdown, dropping them would lose edits.
+            if (jobs.empty()) return;
+
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        bool success = MapSerializer::save(job.filename, *job.data);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(job.filename, error);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (success && !error) {
+            writtenFiles[job.filename] = writeTime;
+        }
+        results.push_back({job.filename, success, elapsed.count()});
+        activeJobs--;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef MAP_SAVER_H
+#define MAP_SAVER_H
+
+#include <string>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "map_data.h"
+
+struct MapSaveResult {
+    std::string filename;
+    bool success;
+    double seconds;
+};
+
+// Serializes map snapshots on a background thread so saving never stalls the
+// editor. Queuing a file that is still waiting replaces its older snapshot.
+class MapSaver {
+public:
+    MapSaver();
+    ~MapSaver();
+
+    void start();
+    // Finishes every queued save before returning.
+    void shutdown();
+
+    void queueSave(const std::string& filename, std::shared_ptr<const MapData> data);
+    bool popResult(MapSaveResult& result);
+
+    bool isSaving() const;
+
+    // True when the file still has the modification time of our last write
+    // to it, so watchers can tell our own saves from outside edits.
+    bool isOwnWrite(const std::string& filename, std::filesystem::file_time_type writeTime) const;
+
+private:
+    struct SaveJob {
+        std::string filename;
+        std::shared_ptr<const MapData> data;
+    };
+
+    std::thread worker;
+    std::deque<SaveJob> jobs;
+    std::deque<MapSaveResult> results;
+    int activeJobs;
+    std::map<std::string, std::filesystem::file_time_type> writtenFiles;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobCondition;
+    bool stopping;
+
+    void workerLoop();
+};
+
+#endif // MAP_SAVER_H
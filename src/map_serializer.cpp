@@ -0,0 +1,713 @@
+#include "map_serializer.h"
+#include "mapped_file.h"
+#include "atomic_file.h"
+#include "map_journal.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <json.hpp>
+
+namespace {
+
+uint32_t alignTo4(uint32_t value) {
+    return (value + 3) & ~3u;
+}
+
+bool loadBinaryDecorations(const unsigned char* bytes, size_t size, const MapFileHeader& header,
+                           MapData& data, const std::string& filename) {
+    uint64_t tileCount = static_cast<uint64_t>(header.width) * header.height;
+    uint64_t offset = header.decorationsOffset;
+
+    uint32_t layerCount;
+    if (offset + sizeof(layerCount) > size) {
+        std::cerr << "Truncated map file: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&layerCount, bytes + offset, sizeof(layerCount));
+    offset += sizeof(layerCount);
+
+    for (uint32_t layer = 0; layer < layerCount; layer++) {
+        uint16_t length;
+        if (offset + sizeof(length) > size) {
+            std::cerr << "Truncated map file: " << filename << std::endl;
+            return false;
+        }
+        std::memcpy(&length, bytes + offset, sizeof(length));
+        offset += sizeof(length);
+
+        if (offset + length > size) {
+            std::cerr << "Truncated map file: " << filename << std::endl;
+            return false;
+        }
+        std::string name(reinterpret_cast<const char*>(bytes + offset), length);
+        offset = alignTo4(static_cast<uint32_t>(offset + length));
+
+        if (offset + tileCount * sizeof(uint16_t) > size) {
+            std::cerr << "Truncated map file: " << filename << std::endl;
+            return false;
+        }
+
+        data.decorations.push_back({name, std::vector<uint16_t>(tileCount)});
+        std::vector<uint16_t>& tiles = data.decorations.back().tiles;
+        std::memcpy(tiles.data(), bytes + offset, tileCount * sizeof(uint16_t));
+        offset += tileCount * sizeof(uint16_t);
+
+        for (uint16_t value : tiles) {
+            if (value >= header.paletteCount) {
+                std::cerr << "Corrupt tile data in map file: " << filename << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Streams a JSON map straight into MapData without building a DOM.
+//
+// Legacy maps list one object per tile under "tiles". Each tile is written
+// into the columns as soon as its object closes; if the map dimensions have
+// not been seen yet (dump() sorts "width" after "tiles") it is parked in a
+// compact list and placed at the end.
+//
+// Version 2 maps carry a "palette" and run-length encoded rows under
+// "layers", optionally with a "decorations" list of named layers. Runs are
+// collected as they stream in and expanded in finish(), once the palette and
+// dimensions are known regardless of key order.
+class MapJsonSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    explicit MapJsonSaxHandler(MapData& data)
+        : data(data), depth(0), skipDepth(0), inTiles(false), inTile(false),
+          inPalette(false), inLayers(false), inDecorations(false), inDecorationTiles(false),
+          currentLayer(LAYER_NONE), rowIndex(-1),
+          pendingRunLength(-1), hasWidth(false), hasHeight(false), hasTileSize(false),
+          hasTiles(false), hasLayers(false), version(1), width(0), height(0) {
+        data.clearPalette();
+        data.width = 0;
+        data.height = 0;
+        data.decorations.clear();
+        data.autotile = false;
+    }
+
+    bool null() override { return true; }
+    bool boolean(bool val) override {
+        if (skipDepth > 0) return true;
+
+        if (inTile && currentKey == "walkable") tile.walkable = val ? 1 : 0;
+        else if (depth == 1 && currentKey == "autotile") data.autotile = val;
+        return true;
+    }
+    bool number_integer(number_integer_t val) override { return number(static_cast<long long>(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return number(static_cast<long long>(val)); }
+    bool number_float(number_float_t val, const string_t&) override { return number(static_cast<long long>(val)); }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& val) override {
+        if (skipDepth > 0) return true;
+
+        if (inTile) {
+            if (currentKey == "textureID") tile.ground = data.internTexture(val);
+            else if (currentKey == "objectTexture") tile.objects = data.internTexture(val);
+        } else if (inPalette && depth == 2) {
+            filePalette.push_back(val);
+        } else if (inDecorations && depth == 4 && currentKey == "name") {
+            decorations.back().name = val;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        depth++;
+        if (skipDepth > 0) return true;
+
+        if (inTiles && depth == 3) {
+            inTile = true;
+            tile = PendingTile();
+        } else if (depth == 2 && currentKey == "layers") {
+            inLayers = true;
+            hasLayers = true;
+        } else if (inDecorations && depth == 4) {
+            decorations.push_back(PendingDecoration());
+        } else if (depth > 1) {
+            skipDepth = depth;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (skipDepth == depth) skipDepth = 0;
+
+        if (inTile && depth == 3) {
+            inTile = false;
+            commitTile();
+        }
+        if (inLayers && depth == 2) inLayers = false;
+
+        depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        depth++;
+        if (skipDepth > 0) return true;
+
+        if (depth == 2 && currentKey == "tiles") {
+            inTiles = true;
+            hasTiles = true;
+        } else if (depth == 2 && currentKey == "palette") {
+            inPalette = true;
+        } else if (inLayers && depth == 3 && currentKey == "decorations") {
+            inDecorations = true;
+        } else if (inLayers && depth == 3) {
+            currentLayer = layerFromKey(currentKey);
+            rowIndex = -1;
+            if (currentLayer == LAYER_NONE) skipDepth = depth;
+        } else if (currentLayer != LAYER_NONE && depth == 4) {
+            rowIndex++;
+            pendingRunLength = -1;
+        } else if (inDecorations && depth == 5 && currentKey == "tiles") {
+            inDecorationTiles = true;
+            rowIndex = -1;
+        } else if (inDecorationTiles && depth == 6) {
+            rowIndex++;
+            pendingRunLength = -1;
+        } else {
+            skipDepth = depth;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (skipDepth == depth) skipDepth = 0;
+
+        if (inTiles && depth == 2) inTiles = false;
+        if (inPalette && depth == 2) inPalette = false;
+        if (currentLayer != LAYER_NONE && depth == 3) currentLayer = LAYER_NONE;
+        if (inDecorationTiles && depth == 5) inDecorationTiles = false;
+        if (inDecorations && depth == 3) inDecorations = false;
+
+        depth--;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        currentKey = val;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        return false;
+    }
+
+    // Maps without a "version" are legacy version 1 maps.
+    bool finish() {
+        if (!hasWidth || !hasHeight || !hasTileSize) {
+            return false;
+        }
+
+        if (version < 1 || version > MAP_JSON_VERSION) {
+            error = "unsupported map version " + std::to_string(version);
+            return false;
+        }
+        if (version == 1 && !hasTiles) {
+            error = "version 1 map without \"tiles\"";
+            return false;
+        }
+        if (version >= 2 && !hasLayers) {
+            error = "version " + std::to_string(version) + " map without \"layers\"";
+            return false;
+        }
+
+        ensureGrid();
+        for (const auto& parked : parkedTiles) {
+            placeTile(parked);
+        }
+        parkedTiles.clear();
+
+        return expandRuns();
+    }
+
+    const std::string& getError() const { return error; }
+
+private:
+    enum Layer {
+        LAYER_GROUND,
+        LAYER_OBJECTS,
+        LAYER_WALKABLE,
+        LAYER_NONE
+    };
+
+    struct PendingTile {
+        int x = -1;
+        int y = -1;
+        uint16_t ground = 0;
+        uint16_t objects = 0;
+        uint8_t walkable = 1;
+    };
+
+    struct Run {
+        int row;
+        int length;
+        int value;
+    };
+
+    struct PendingDecoration {
+        std::string name;
+        std::vector<Run> runs;
+    };
+
+    MapData& data;
+    std::string currentKey;
+    std::string error;
+    int depth;
+    int skipDepth;
+    bool inTiles;
+    bool inTile;
+    bool inPalette;
+    bool inLayers;
+    bool inDecorations;
+    bool inDecorationTiles;
+    Layer currentLayer;
+    int rowIndex;
+    long long pendingRunLength;
+    bool hasWidth, hasHeight, hasTileSize;
+    bool hasTiles, hasLayers;
+    long long version;
+    int width, height;
+    PendingTile tile;
+    std::vector<PendingTile> parkedTiles;
+    std::vector<std::string> filePalette;
+    std::vector<Run> runs[LAYER_NONE];
+    std::vector<PendingDecoration> decorations;
+
+    static Layer layerFromKey(const std::string& name) {
+        if (name == "ground") return LAYER_GROUND;
+        if (name == "objects") return LAYER_OBJECTS;
+        if (name == "walkable") return LAYER_WALKABLE;
+        return LAYER_NONE;
+    }
+
+    bool number(long long val) {
+        if (skipDepth > 0) return true;
+
+        if (inTile) {
+            if (currentKey == "x") tile.x = static_cast<int>(val);
+            else if (currentKey == "y") tile.y = static_cast<int>(val);
+        } else if (currentLayer != LAYER_NONE && depth == 4) {
+            addRunValue(runs[currentLayer], val);
+        } else if (inDecorationTiles && depth == 6) {
+            addRunValue(decorations.back().runs, val);
+        } else if (depth == 1) {
+            if (currentKey == "width") { width = static_cast<int>(val); hasWidth = true; }
+            else if (currentKey == "height") { height = static_cast<int>(val); hasHeight = true; }
+            else if (currentKey == "tileSize") { data.tileSize = static_cast<int>(val); hasTileSize = true; }
+            else if (currentKey == "version") { version = val; }
+        }
+        return true;
+    }
+
+    // Rows are flat [length, value, ...] lists, values arrive one at a time.
+    void addRunValue(std::vector<Run>& target, long long val) {
+        if (pendingRunLength < 0) {
+            pendingRunLength = val;
+        } else {
+            target.push_back({rowIndex, static_cast<int>(pendingRunLength), static_cast<int>(val)});
+            pendingRunLength = -1;
+        }
+    }
+
+    void ensureGrid() {
+        if (data.width != width || data.height != height) {
+            data.resize(width, height);
+        }
+    }
+
+    void commitTile() {
+        if (hasWidth && hasHeight) {
+            ensureGrid();
+            placeTile(tile);
+        } else {
+            parkedTiles.push_back(tile);
+        }
+    }
+
+    void placeTile(const PendingTile& pending) {
+        if (!data.contains(pending.x, pending.y)) return;
+
+        int i = data.index(pending.x, pending.y);
+        data.ground[i] = pending.ground;
+        data.objects[i] = pending.objects;
+        data.walkable[i] = pending.walkable;
+    }
+
+    bool expandRuns() {
+        std::vector<uint16_t> remap;
+        for (const auto& textureID : filePalette) {
+            remap.push_back(data.internTexture(textureID));
+        }
+
+        if (!expandLayer(runs[LAYER_GROUND], remap, false, data.ground) ||
+            !expandLayer(runs[LAYER_OBJECTS], remap, false, data.objects) ||
+            !expandLayer(runs[LAYER_WALKABLE], remap, true, data.walkable)) {
+            return false;
+        }
+
+        for (const auto& pending : decorations) {
+            data.decorations.push_back({pending.name, std::vector<uint16_t>(data.ground.size(), 0)});
+            if (!expandLayer(pending.runs, remap, false, data.decorations.back().tiles)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    bool expandLayer(const std::vector<Run>& layerRuns, const std::vector<uint16_t>& remap, bool flags,
+                     std::vector<T>& column) {
+        int row = -1;
+        int x = 0;
+
+        for (const auto& run : layerRuns) {
+            if (run.row != row) {
+                row = run.row;
+                x = 0;
+            }
+
+            if (row >= height || run.length < 0 || x + run.length > width) {
+                error = "run length exceeds map width";
+                return false;
+            }
+
+            T value;
+            if (flags) {
+                value = run.value != 0 ? 1 : 0;
+            } else if (run.value >= 0 && run.value < static_cast<int>(remap.size())) {
+                value = static_cast<T>(remap[run.value]);
+            } else {
+                error = "palette index out of range";
+                return false;
+            }
+
+            int start = data.index(x, row);
+            std::fill(column.begin() + start, column.begin() + start + run.length, value);
+            x += run.length;
+        }
+
+        return true;
+    }
+};
+
+// Writes one layer as rows of [length, value, length, value, ...] runs, one
+// row per line so edits show up as small text diffs.
+template<typename T>
+void writeRunRows(std::ostream& out, const MapData& data, const std::vector<T>& column,
+                  const std::string& indent = "        ") {
+    out << "[\n";
+    for (int y = 0; y < data.height; y++) {
+        out << indent << "    [";
+
+        int x = 0;
+        while (x < data.width) {
+            T value = column[data.index(x, y)];
+            int length = 1;
+            while (x + length < data.width && column[data.index(x + length, y)] == value) {
+                length++;
+            }
+
+            if (x > 0) out << ", ";
+            out << length << ", " << static_cast<int>(value);
+            x += length;
+        }
+
+        out << "]" << (y + 1 < data.height ? ",\n" : "\n");
+    }
+    out << indent << "]";
+}
+
+}
+
+bool MapSerializer::isBinaryPath(const std::string& filename) {
+    const std::string extension = ".bmap";
+    return filename.size() >= extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool MapSerializer::load(const std::string& filename, MapData& data) {
+    bool loaded = isBinaryPath(filename) ? loadBinary(filename, data) : loadJson(filename, data);
+    if (!loaded) {
+        return false;
+    }
+
+    // Edits made since the last compaction live in the journal next to the map.
+    int replayed = MapJournal::replay(filename, data);
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " journaled edits onto " << filename << std::endl;
+    }
+    return true;
+}
+
+bool MapSerializer::save(const std::string& filename, const MapData& data) {
+    return isBinaryPath(filename) ? saveBinary(filename, data) : saveJson(filename, data);
+}
+
+bool MapSerializer::loadJson(const std::string& filename, MapData& data) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Failed to open file for reading: " << filename << std::endl;
+        return false;
+    }
+
+    try {
+        const char* begin = reinterpret_cast<const char*>(file.getData());
+        const char* end = begin + file.getSize();
+
+        MapJsonSaxHandler handler(data);
+        if (!nlohmann::json::sax_parse(begin, end, &handler)) {
+            std::cerr << "Error loading map: " << handler.getError() << std::endl;
+            return false;
+        }
+
+        if (!handler.finish()) {
+            std::cerr << "Invalid map file format";
+            if (!handler.getError().empty()) {
+                std::cerr << ": " << handler.getError();
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading map: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool MapSerializer::saveJson(const std::string& filename, const MapData& data) {
+    try {
+        std::ostringstream out;
+        writeJson(out, data);
+
+        std::string text = out.str();
+        return writeFileAtomic(filename, text.data(), text.size());
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving map: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void MapSerializer::writeJson(std::ostream& out, const MapData& data) {
+    out << "{\n";
+    out << "    \"version\": " << MAP_JSON_VERSION << ",\n";
+    out << "    \"width\": " << data.width << ",\n";
+    out << "    \"height\": " << data.height << ",\n";
+    out << "    \"tileSize\": " << data.tileSize << ",\n";
+    if (data.autotile) {
+        out << "    \"autotile\": true,\n";
+    }
+
+    out << "    \"palette\": [";
+    for (size_t i = 0; i < data.palette.size(); i++) {
+        if (i > 0) out << ", ";
+        out << nlohmann::json(data.palette[i]).dump();
+    }
+    out << "],\n";
+
+    out << "    \"layers\": {\n";
+    out << "        \"ground\": ";
+    writeRunRows(out, data, data.ground);
+    out << ",\n        \"objects\": ";
+    writeRunRows(out, data, data.objects);
+    out << ",\n        \"walkable\": ";
+    writeRunRows(out, data, data.walkable);
+
+    if (!data.decorations.empty()) {
+        out << ",\n        \"decorations\": [";
+        for (size_t i = 0; i < data.decorations.size(); i++) {
+            const MapDataLayer& layer = data.decorations[i];
+            out << (i > 0 ? ",\n" : "\n");
+            out << "            {\n";
+            out << "                \"name\": " << nlohmann::json(layer.name).dump() << ",\n";
+            out << "                \"tiles\": ";
+            writeRunRows(out, data, layer.tiles, "                ");
+            out << "\n            }";
+        }
+        out << "\n        ]";
+    }
+
+    out << "\n    }\n";
+    out << "}\n";
+}
+
+bool MapSerializer::loadBinary(const std::string& filename, MapData& data) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Failed to open file for reading: " << filename << std::endl;
+        return false;
+    }
+
+    const unsigned char* bytes = file.getData();
+    size_t size = file.getSize();
+
+    MapFileHeader header;
+    if (size < sizeof(header)) {
+        std::cerr << "Invalid map file format" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, bytes, sizeof(header));
+
+    if (std::memcmp(header.magic, MAP_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version < 1 || header.version > MAP_FILE_VERSION ||
+        header.paletteCount == 0 || header.paletteCount > 65536) {
+        std::cerr << "Invalid map file format" << std::endl;
+        return false;
+    }
+
+    uint32_t flags = 0;
+    if (header.version >= 2) {
+        if (size < sizeof(header) + sizeof(flags) || header.stringTableOffset < sizeof(header) + sizeof(flags)) {
+            std::cerr << "Invalid map file format" << std::endl;
+            return false;
+        }
+        std::memcpy(&flags, bytes + sizeof(header), sizeof(flags));
+    }
+
+    uint64_t tileCount = static_cast<uint64_t>(header.width) * header.height;
+    if (static_cast<uint64_t>(header.stringTableOffset) + header.stringTableSize > size ||
+        header.groundOffset + tileCount * sizeof(uint16_t) > size ||
+        header.objectsOffset + tileCount * sizeof(uint16_t) > size ||
+        header.walkableOffset + tileCount > size) {
+        std::cerr << "Truncated map file: " << filename << std::endl;
+        return false;
+    }
+
+    data.palette.clear();
+    data.paletteLookup.clear();
+
+    const unsigned char* strings = bytes + header.stringTableOffset;
+    const unsigned char* stringsEnd = strings + header.stringTableSize;
+
+    for (uint32_t i = 0; i < header.paletteCount; i++) {
+        uint16_t length;
+        if (stringsEnd - strings < static_cast<ptrdiff_t>(sizeof(length))) {
+            std::cerr << "Truncated map file: " << filename << std::endl;
+            return false;
+        }
+        std::memcpy(&length, strings, sizeof(length));
+        strings += sizeof(length);
+
+        if (stringsEnd - strings < length) {
+            std::cerr << "Truncated map file: " << filename << std::endl;
+            return false;
+        }
+
+        std::string textureID(reinterpret_cast<const char*>(strings), length);
+        strings += length;
+
+        data.paletteLookup[textureID] = static_cast<uint16_t>(data.palette.size());
+        data.palette.push_back(textureID);
+    }
+
+    if (!data.palette[0].empty()) {
+        std::cerr << "Invalid map file format" << std::endl;
+        return false;
+    }
+
+    data.width = static_cast<int>(header.width);
+    data.height = static_cast<int>(header.height);
+    data.tileSize = static_cast<int>(header.tileSize);
+    data.autotile = (flags & MAP_FILE_FLAG_AUTOTILE) != 0;
+
+    data.ground.resize(tileCount);
+    data.objects.resize(tileCount);
+    data.walkable.resize(tileCount);
+    data.decorations.clear();
+
+    std::memcpy(data.ground.data(), bytes + header.groundOffset, tileCount * sizeof(uint16_t));
+    std::memcpy(data.objects.data(), bytes + header.objectsOffset, tileCount * sizeof(uint16_t));
+    std::memcpy(data.walkable.data(), bytes + header.walkableOffset, tileCount);
+
+    for (uint64_t i = 0; i < tileCount; i++) {
+        if (data.ground[i] >= header.paletteCount || data.objects[i] >= header.paletteCount) {
+            std::cerr << "Corrupt tile data in map file: " << filename << std::endl;
+            return false;
+        }
+    }
+
+    if (header.decorationsOffset != 0) {
+        return loadBinaryDecorations(bytes, size, header, data, filename);
+    }
+
+    return true;
+}
+
+bool MapSerializer::saveBinary(const std::string& filename, const MapData& data) {
+    std::string strings;
+    for (const auto& textureID : data.palette) {
+        uint16_t length = static_cast<uint16_t>(textureID.size());
+        strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        strings += textureID;
+    }
+
+    uint32_t tileCount = static_cast<uint32_t>(data.width) * data.height;
+
+    MapFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+    header.version = MAP_FILE_VERSION;
+    header.width = static_cast<uint32_t>(data.width);
+    header.height = static_cast<uint32_t>(data.height);
+    header.tileSize = static_cast<uint32_t>(data.tileSize);
+    header.paletteCount = static_cast<uint32_t>(data.palette.size());
+    header.stringTableOffset = sizeof(MapFileHeader) + sizeof(uint32_t);
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.groundOffset = alignTo4(header.stringTableOffset + header.stringTableSize);
+    header.objectsOffset = alignTo4(header.groundOffset + tileCount * sizeof(uint16_t));
+    header.walkableOffset = alignTo4(header.objectsOffset + tileCount * sizeof(uint16_t));
+    if (!data.decorations.empty()) {
+        header.decorationsOffset = alignTo4(header.walkableOffset + tileCount);
+    }
+
+    std::string buffer;
+    buffer.reserve(header.walkableOffset + tileCount);
+
+    auto padTo = [&buffer](uint32_t offset) {
+        buffer.resize(offset, '\0');
+    };
+
+    uint32_t flags = data.autotile ? MAP_FILE_FLAG_AUTOTILE : 0;
+
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.append(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    buffer += strings;
+
+    padTo(header.groundOffset);
+    buffer.append(reinterpret_cast<const char*>(data.ground.data()), tileCount * sizeof(uint16_t));
+
+    padTo(header.objectsOffset);
+    buffer.append(reinterpret_cast<const char*>(data.objects.data()), tileCount * sizeof(uint16_t));
+
+    padTo(header.walkableOffset);
+    buffer.append(reinterpret_cast<const char*>(data.walkable.data()), tileCount);
+
+    if (header.decorationsOffset != 0) {
+        padTo(header.decorationsOffset);
+
+        uint32_t layerCount = static_cast<uint32_t>(data.decorations.size());
+        buffer.append(reinterpret_cast<const char*>(&layerCount), sizeof(layerCount));
+
+        for (const auto& layer : data.decorations) {
+            uint16_t length = static_cast<uint16_t>(layer.name.size());
+            buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            buffer += layer.name.substr(0, length);
+
+            padTo(alignTo4(static_cast<uint32_t>(buffer.size())));
+            buffer.append(reinterpret_cast<const char*>(layer.tiles.data()), tileCount * sizeof(uint16_t));
+        }
+    }
+
+    return writeFileAtomic(filename, buffer.data(), buffer.size());
+}
\ No newline at end of file
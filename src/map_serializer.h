@@ -0,0 +1,70 @@
+#ifndef MAP_SERIALIZER_H
+#define MAP_SERIALIZER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "map_data.h"
+
+// JSON maps are written as version 2: a texture "palette" plus "layers"
+// holding ground, objects and walkable as run-length encoded rows of
+// [length, value, ...]. Maps with decoration layers add a "decorations"
+// list of {"name", "tiles"} to "layers" in the same row format. The legacy
+// per-tile "tiles" array is still read.
+const int MAP_JSON_VERSION = 2;
+
+// Binary map layout (little endian), version 2:
+//   MapFileHeader (48 bytes)
+//   uint32 flags, MAP_FILE_FLAG_* bits
+//   string table: paletteCount x (uint16 length, bytes)
+//   ground column: uint16[width * height]    at groundOffset
+//   object column: uint16[width * height]    at objectsOffset
+//   walkable column: uint8[width * height]   at walkableOffset
+//   decorations (optional)                   at decorationsOffset, 0 when absent:
+//     uint32 layerCount, then per layer uint16 name length, name bytes,
+//     padding to 4 bytes and a uint16[width * height] column
+// Columns are 4 byte aligned and indexed y * width + x. Version 1 files are
+// still read, they have no flags word and the string table follows the header.
+const char MAP_FILE_MAGIC[4] = {'M', 'A', 'D', 'M'};
+const uint32_t MAP_FILE_VERSION = 2;
+
+// Bits of the flags word.
+const uint32_t MAP_FILE_FLAG_AUTOTILE = 1 << 0;
+
+struct MapFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t paletteCount;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint32_t groundOffset;
+    uint32_t objectsOffset;
+    uint32_t walkableOffset;
+    uint32_t decorationsOffset;
+};
+
+static_assert(sizeof(MapFileHeader) == 48, "MapFileHeader layout changed");
+
+// Reads and writes map files. Nothing here touches SDL or the live TileMap,
+// so it is safe to call from background threads.
+class MapSerializer {
+public:
+    // Picks the format from the extension, .bmap is binary and anything else JSON.
+    // load() also replays the map's edit journal on top of the file.
+    static bool load(const std::string& filename, MapData& data);
+    static bool save(const std::string& filename, const MapData& data);
+
+    static bool loadJson(const std::string& filename, MapData& data);
+    static bool saveJson(const std::string& filename, const MapData& data);
+    static void writeJson(std::ostream& out, const MapData& data);
+
+    static bool loadBinary(const std::string& filename, MapData& data);
+    static bool saveBinary(const std::string& filename, const MapData& data);
+
+    static bool isBinaryPath(const std::string& filename);
+};
+
+#endif // MAP_SERIALIZER_H
@@ -0,0 +1,157 @@
+#include "minimap.h"
+#include "map_indexer.h"
+#include <algorithm>
+#include <iostream>
+
+Minimap::Minimap() : texture(nullptr), width(0), height(0), source(nullptr), colorVersion(-1),
+                     screenRect({0, 0, 0, 0}), dragging(false) {
+}
+
+Minimap::~Minimap() {
+    destroy();
+}
+
+void Minimap::destroy() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    width = 0;
+    height = 0;
+    source = nullptr;
+}
+
+void Minimap::update(Renderer& renderer, TileMap* tileMap) {
+    if (!tileMap || !renderer.getRenderer()) return;
+
+    SDL_Rect dirty;
+    bool hasDirty = tileMap->takeDirtyRect(dirty);
+
+    bool rebuild = tileMap != source || colorVersion != renderer.getAverageColorVersion() ||
+                   width != tileMap->getGridWidth() || height != tileMap->getGridHeight();
+
+    if (rebuild) {
+        if (!texture || width != tileMap->getGridWidth() || height != tileMap->getGridHeight()) {
+            if (texture) {
+                SDL_DestroyTexture(texture);
+            }
+
+            width = tileMap->getGridWidth();
+            height = tileMap->getGridHeight();
+            texture = SDL_CreateTexture(renderer.getRenderer(), SDL_PIXELFORMAT_ARGB8888,
+                                        SDL_TEXTUREACCESS_STREAMING, width, height);
+            if (!texture) {
+                std::cerr << "Failed to create minimap texture: " << SDL_GetError() << std::endl;
+                width = 0;
+                height = 0;
+                return;
+            }
+        }
+
+        source = tileMap;
+        colorVersion = renderer.getAverageColorVersion();
+        colorCache.clear();
+
+        uploadRect(renderer, {0, 0, width, height});
+    } else if (hasDirty) {
+        uploadRect(renderer, dirty);
+    }
+}
+
+void Minimap::uploadRect(Renderer& renderer, const SDL_Rect& rect) {
+    texels.resize(static_cast<size_t>(rect.w) * rect.h);
+
+    for (int y = 0; y < rect.h; y++) {
+        for (int x = 0; x < rect.w; x++) {
+            int tileX = rect.x + x;
+            int tileY = rect.y + y;
+
+            const std::string& textureID = source->getObjectTexture(tileX, tileY).empty()
+                ? source->getGroundTexture(tileX, tileY) : source->getObjectTexture(tileX, tileY);
+
+            Uint32 color = getTextureColor(renderer, textureID);
+            if (!source->isWalkable(tileX, tileY)) {
+                color = 0xFF000000u | ((color >> 1) & 0x007F7F7Fu);
+            }
+
+            texels[static_cast<size_t>(y) * rect.w + x] = color;
+        }
+    }
+
+    SDL_UpdateTexture(texture, &rect, texels.data(), rect.w * sizeof(Uint32));
+}
+
+Uint32 Minimap::getTextureColor(Renderer& renderer, const std::string& textureID) {
+    auto it = colorCache.find(textureID);
+    if (it != colorCache.end()) {
+        return it->second;
+    }
+
+    Uint32 color;
+    SDL_Color average;
+    if (!textureID.empty() && renderer.getAverageColor(textureID, average)) {
+        color = 0xFF000000u | (average.r << 16) | (average.g << 8) | average.b;
+    } else {
+        // Not uploaded yet, use the browser thumbnail colour until it is.
+        Uint32 thumbnail = MapIndexer::getThumbnailColor(textureID);
+        color = 0xFF000000u | ((thumbnail & 0xFF) << 16) | (thumbnail & 0xFF00) | ((thumbnail >> 16) & 0xFF);
+    }
+
+    colorCache[textureID] = color;
+    return color;
+}
+
+void Minimap::render(Renderer& renderer, int x, int y, int scale) {
+    if (!texture || !source) return;
+
+    screenRect = {x, y, width * scale, height * scale};
+
+    renderer.setDrawColor(0, 0, 0, 255);
+    renderer.fillRect(x - 2, y - 2, screenRect.w + 4, screenRect.h + 4);
+    SDL_RenderCopy(renderer.getRenderer(), texture, nullptr, &screenRect);
+
+    // Outline of the part of the map that is on screen.
+    float texelsPerPixel = static_cast<float>(scale) / source->getTileSize();
+    renderer.setDrawColor(255, 255, 255, 255);
+    renderer.drawRect(x + static_cast<int>(source->getViewX() * texelsPerPixel),
+                      y + static_cast<int>(source->getViewY() * texelsPerPixel),
+                      std::min(screenRect.w, static_cast<int>(source->getViewWidth() * texelsPerPixel)),
+                      std::min(screenRect.h, static_cast<int>(source->getViewHeight() * texelsPerPixel)));
+}
+
+bool Minimap::handleEvent(const SDL_Event& e) {
+    if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) {
+        dragging = panToScreen(e.button.x, e.button.y);
+        return dragging;
+    }
+
+    if (e.type == SDL_MOUSEMOTION && dragging) {
+        panToScreen(std::max(screenRect.x, std::min(e.motion.x, screenRect.x + screenRect.w - 1)),
+                    std::max(screenRect.y, std::min(e.motion.y, screenRect.y + screenRect.h - 1)));
+        return true;
+    }
+
+    if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_LEFT && dragging) {
+        dragging = false;
+        return true;
+    }
+
+    return false;
+}
+
+bool Minimap::panToScreen(int screenX, int screenY) {
+    SDL_Point point = {screenX, screenY};
+    if (!source || screenRect.w <= 0 || !SDL_PointInRect(&point, &screenRect)) {
+        return false;
+    }
+
+    panTo(static_cast<float>(screenX - screenRect.x) / screenRect.w,
+          static_cast<float>(screenY - screenRect.y) / screenRect.h);
+    return true;
+}
+
+void Minimap::panTo(float u, float v) {
+    if (!source) return;
+
+    source->centerViewOn(static_cast<int>(u * width), static_cast<int>(v * height));
+}
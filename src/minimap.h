@@ -0,0 +1,55 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "renderer.h"
+#include "tilemap.h"
+
+// One texel per tile in a streaming texture. The whole texture is rebuilt
+// when the map or the texture colours change, otherwise only the TileMap's
+// dirty rect is re-uploaded. Tiles take the averaged colour of their object,
+// or of their ground when there is none, blocked tiles are drawn darker.
+class Minimap {
+public:
+    Minimap();
+    ~Minimap();
+
+    void update(Renderer& renderer, TileMap* tileMap);
+
+    // Screen space, draws the texture scaled up with the visible area outlined.
+    void render(Renderer& renderer, int x, int y, int scale);
+
+    // Pans the map when a left click or drag lands on the last rendered
+    // minimap. Returns true when the event was used.
+    bool handleEvent(const SDL_Event& e);
+
+    // Centres the source map's view on the texel at (u, v) in [0, 1].
+    void panTo(float u, float v);
+
+    SDL_Texture* getTexture() const { return texture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void destroy();
+
+private:
+    SDL_Texture* texture;
+    int width, height;
+    TileMap* source;
+    int colorVersion;
+
+    std::vector<Uint32> texels;
+    std::unordered_map<std::string, Uint32> colorCache;
+
+    SDL_Rect screenRect;
+    bool dragging;
+
+    Uint32 getTextureColor(Renderer& renderer, const std::string& textureID);
+    void uploadRect(Renderer& renderer, const SDL_Rect& rect);
+    bool panToScreen(int screenX, int screenY);
+};
+
+#endif // MINIMAP_H
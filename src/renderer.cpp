@@ -1,7 +1,9 @@
 #include "renderer.h"
 #include <iostream>
 
-Renderer::Renderer() : renderer(nullptr) {
+Renderer::Renderer() : renderer(nullptr), font(nullptr), viewOffsetX(0), viewOffsetY(0), textureBudget(64 * 1024 * 1024), residentBytes(0),
+                       frameCounter(0), evictionCount(0), reloadCount(0), archiveFormatSupported(false),
+                       averageColorVersion(0), textureGeneration(0), reloadGeneration(0) {
 
 }
 
@@ -23,16 +25,29 @@ void Renderer::initialize(SDL_Renderer* sdlRenderer) {
     if (!font) {
         std::cerr << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << std::endl;
     }
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.num_texture_formats > 0) {
+        assetLoader.setTargetFormat(info.texture_formats[0]);
+    }
+
+    assetLoader.start();
 }
 
 void Renderer::cleanup() {
+    assetLoader.shutdown();
+    archive.close();
+
     for (auto& pair : textureMap) {
-        if (pair.second) {
-            SDL_DestroyTexture(pair.second);
+        if (pair.second.texture) {
+            SDL_DestroyTexture(pair.second.texture);
         }
     }
 
     textureMap.clear();
+    residentBytes = 0;
+    textureRefCounts.clear();
+    pendingTextures.clear();
 
     if (font) {
         TTF_CloseFont(font);
@@ -49,6 +64,7 @@ void Renderer::clear() {
 
 void Renderer::present() {
     SDL_RenderPresent(renderer);
+    frameCounter++;
 }
 
 void Renderer::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
@@ -56,27 +72,28 @@ void Renderer::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
 }
 
 void Renderer::fillRect(int x, int y, int w, int h) {
-    SDL_Rect rect = {x, y, w, h};
+    SDL_Rect rect = {x - viewOffsetX, y - viewOffsetY, w, h};
     SDL_RenderFillRect(renderer, &rect);
 }
 
 void Renderer::fillRect(const SDL_Rect& rect) {
-    SDL_RenderFillRect(renderer, &rect);
+    fillRect(rect.x, rect.y, rect.w, rect.h);
 }
 
 void Renderer::drawRect(int x, int y, int w, int h) {
-    SDL_Rect rect = {x, y, w, h};
+    SDL_Rect rect = {x - viewOffsetX, y - viewOffsetY, w, h};
     SDL_RenderDrawRect(renderer, &rect);
 }
 
 void Renderer::drawRect(const SDL_Rect& rect) {
-    SDL_RenderDrawRect(renderer, &rect);
+    drawRect(rect.x, rect.y, rect.w, rect.h);
 }
 
 void Renderer::drawText(const std::string& text, int x, int y) {
     if (!font) {
+        SDL_Rect rect = {x, y, static_cast<int>(text.length()) * 8, 15};
         setDrawColor(255, 255, 255, 255);
-        fillRect(x, y, text.length() * 8, 15);
+        SDL_RenderFillRect(renderer, &rect);
         return;
     }
 
@@ -117,6 +134,62 @@ bool Renderer::loadTexture(const std::string& id, const std::string& filePath) {
         return false;
     }
 
+    return createTexture(id, surface, filePath);
+}
+
+void Renderer::requestTexture(const std::string& id, const std::string& filePath) {
+    if (textureMap.find(id) != textureMap.end() || pendingTextures.count(id) > 0) {
+        return;
+    }
+
+    pendingTextures.insert(id);
+    assetLoader.queueImage(id, filePath);
+}
+
+int Renderer::processLoadedTextures(int maxUploads) {
+    int uploaded = 0;
+    DecodedImage image;
+
+    while ((maxUploads < 0 || uploaded < maxUploads) && assetLoader.popDecoded(image)) {
+        pendingTextures.erase(image.id);
+        bool reloading = reloadingTextures.erase(image.id) > 0;
+
+        if (!image.surface) {
+            std::cerr << "Failed to load image " << image.filePath << ": " << image.error << std::endl;
+            if (!reloading) {
+                missingTextures.insert(image.id);
+            }
+            continue;
+        }
+
+        if (!reloading && textureMap.find(image.id) != textureMap.end()) {
+            SDL_FreeSurface(image.surface);
+            continue;
+        }
+
+        if (createTexture(image.id, image.surface, image.filePath)) {
+            uploaded++;
+            if (reloading) {
+                reloadGeneration++;
+            }
+        }
+    }
+
+    return uploaded;
+}
+
+float Renderer::getLoadProgress() const {
+    int queued = assetLoader.getQueuedCount();
+    if (queued == 0) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(assetLoader.getFinishedCount()) / queued;
+}
+
+bool Renderer::createTexture(const std::string& id, SDL_Surface* surface, const std::string& filePath) {
+    recordAverageColor(id, surface);
+
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
     SDL_FreeSurface(surface);
 
@@ -125,23 +198,321 @@ bool Renderer::loadTexture(const std::string& id, const std::string& filePath) {
         return false;
     }
 
-    textureMap[id] = texture;
+    addTexture(id, texture);
+    return true;
+}
+
+void Renderer::addTexture(const std::string& id, SDL_Texture* texture) {
+    Uint32 format = 0;
+    int width = 0;
+    int height = 0;
+    SDL_QueryTexture(texture, &format, NULL, &width, &height);
+
+    size_t bytesPerPixel = SDL_BYTESPERPIXEL(format);
+    if (bytesPerPixel == 0) {
+        bytesPerPixel = 4;
+    }
+
+    auto existing = textureMap.find(id);
+    if (existing != textureMap.end()) {
+        destroyTexture(existing);
+    }
+
+    TextureEntry entry;
+    entry.texture = texture;
+    entry.bytes = static_cast<size_t>(width) * height * bytesPerPixel;
+    entry.lastUsedFrame = frameCounter;
+
+    textureMap[id] = entry;
+    residentBytes += entry.bytes;
+
+    if (evictedTextures.erase(id) > 0) {
+        reloadCount++;
+    }
+    textureGeneration++;
+
+    enforceTextureBudget();
+}
+
+void Renderer::destroyTexture(std::map<std::string, TextureEntry>::iterator it) {
+    SDL_DestroyTexture(it->second.texture);
+    residentBytes -= it->second.bytes;
+    textureMap.erase(it);
+}
+
+void Renderer::enforceTextureBudget() {
+    while (residentBytes > textureBudget) {
+        auto oldest = textureMap.end();
+        for (auto it = textureMap.begin(); it != textureMap.end(); ++it) {
+            if (oldest == textureMap.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame) {
+                oldest = it;
+            }
+        }
+
+        // Anything drawn this frame stays, going over budget beats thrashing.
+        if (oldest == textureMap.end() || oldest->second.lastUsedFrame >= frameCounter) {
+            break;
+        }
+
+        evictedTextures.insert(oldest->first);
+        evictionCount++;
+        destroyTexture(oldest);
+    }
+}
+
+void Renderer::setTextureBudget(size_t bytes) {
+    textureBudget = bytes;
+    enforceTextureBudget();
+}
+
+TextureStats Renderer::getTextureStats() const {
+    TextureStats stats;
+    stats.residentBytes = residentBytes;
+    stats.budgetBytes = textureBudget;
+    stats.residentCount = static_cast<int>(textureMap.size());
+    stats.pendingCount = static_cast<int>(pendingTextures.size());
+    stats.evictionCount = evictionCount;
+    stats.reloadCount = reloadCount;
+    return stats;
+}
+
+bool Renderer::openArchive(const std::string& filename) {
+    if (!archive.open(filename)) {
+        return false;
+    }
+
+    archiveFormatSupported = false;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        for (Uint32 i = 0; i < info.num_texture_formats; i++) {
+            if (info.texture_formats[i] == archive.getPixelFormat()) {
+                archiveFormatSupported = true;
+                break;
+            }
+        }
+    }
+
+    if (!archiveFormatSupported) {
+        std::cout << "Asset archive pixel format is not native to this renderer, textures will be converted" << std::endl;
+    }
+
     return true;
 }
 
+bool Renderer::loadTextureFromArchive(const std::string& id) {
+    const AssetArchiveEntry* entry = archive.findEntry(id);
+    if (!entry) {
+        return false;
+    }
+
+    const unsigned char* pixels = archive.getPixels(*entry, archiveScratch);
+    if (!pixels) {
+        std::cerr << "Corrupt archive data for texture '" << id << "'" << std::endl;
+        return false;
+    }
+
+    int width = static_cast<int>(entry->width);
+    int height = static_cast<int>(entry->height);
+    int pitch = static_cast<int>(entry->pitch);
+
+    if (!archiveFormatSupported) {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<unsigned char*>(pixels), width, height,
+                                                                  SDL_BITSPERPIXEL(archive.getPixelFormat()), pitch,
+                                                                  archive.getPixelFormat());
+        if (!surface) {
+            std::cerr << "Failed to wrap archive pixels for '" << id << "': " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        return createTexture(id, surface, "archive:" + id);
+    }
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, archive.getPixelFormat(), SDL_TEXTUREACCESS_STATIC, width, height);
+    if (!texture) {
+        std::cerr << "Failed to create texture '" << id << "': " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    SDL_UpdateTexture(texture, nullptr, pixels, pitch);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    SDL_Surface* view = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<unsigned char*>(pixels), width, height,
+                                                           SDL_BITSPERPIXEL(archive.getPixelFormat()), pitch,
+                                                           archive.getPixelFormat());
+    if (view) {
+        recordAverageColor(id, view);
+        SDL_FreeSurface(view);
+    }
+
+    addTexture(id, texture);
+    return true;
+}
+
+void Renderer::recordAverageColor(const std::string& id, SDL_Surface* surface) {
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!converted) return;
+
+    Uint64 red = 0;
+    Uint64 green = 0;
+    Uint64 blue = 0;
+    Uint64 weight = 0;
+
+    SDL_LockSurface(converted);
+    for (int y = 0; y < converted->h; y++) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(converted->pixels) + y * converted->pitch);
+        for (int x = 0; x < converted->w; x++) {
+            Uint32 alpha = row[x] >> 24;
+            red += ((row[x] >> 16) & 0xFF) * alpha;
+            green += ((row[x] >> 8) & 0xFF) * alpha;
+            blue += (row[x] & 0xFF) * alpha;
+            weight += alpha;
+        }
+    }
+    SDL_UnlockSurface(converted);
+    SDL_FreeSurface(converted);
+
+    if (weight == 0) return;
+
+    averageColors[id] = {static_cast<Uint8>(red / weight), static_cast<Uint8>(green / weight),
+                         static_cast<Uint8>(blue / weight), 255};
+    averageColorVersion++;
+}
+
+bool Renderer::getAverageColor(const std::string& id, SDL_Color& color) const {
+    auto it = averageColors.find(id);
+    if (it == averageColors.end()) {
+        return false;
+    }
+
+    color = it->second;
+    return true;
+}
+
+bool Renderer::loadManifest(const std::string& filename) {
+    if (!manifest.load(filename)) {
+        return false;
+    }
+
+    missingTextures.clear();
+    return true;
+}
+
+void Renderer::acquireTexture(const std::string& id) {
+    textureRefCounts[id]++;
+
+    if (textureMap.find(id) == textureMap.end()) {
+        requestFromManifest(id);
+    }
+}
+
+void Renderer::releaseTexture(const std::string& id) {
+    auto it = textureRefCounts.find(id);
+    if (it == textureRefCounts.end()) {
+        return;
+    }
+
+    if (--it->second > 0) {
+        return;
+    }
+
+    textureRefCounts.erase(it);
+
+    auto textureIt = textureMap.find(id);
+    if (textureIt != textureMap.end()) {
+        destroyTexture(textureIt);
+    }
+    evictedTextures.erase(id);
+}
+
+void Renderer::releaseUnreferencedTextures() {
+    auto it = textureMap.begin();
+    while (it != textureMap.end()) {
+        if (textureRefCounts.find(it->first) == textureRefCounts.end()) {
+            SDL_DestroyTexture(it->second.texture);
+            residentBytes -= it->second.bytes;
+            it = textureMap.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Renderer::reloadTexture(const std::string& id) {
+    if (!manifest.hasTexture(id)) {
+        return;
+    }
+
+    // The archive copy predates the edit, always go back to the source file.
+    staleArchiveTextures.insert(id);
+    missingTextures.erase(id);
+
+    if (textureMap.find(id) == textureMap.end() || reloadingTextures.count(id) > 0) {
+        return;
+    }
+
+    reloadingTextures.insert(id);
+    assetLoader.queueImage(id, manifest.getTexturePath(id));
+}
+
+bool Renderer::requestFromManifest(const std::string& id) {
+    if (pendingTextures.count(id) > 0) {
+        return true;
+    }
+
+    // Archived textures are already decoded, upload them straight from the mapping.
+    if (missingTextures.count(id) == 0 && staleArchiveTextures.count(id) == 0 &&
+        archive.isOpen() && loadTextureFromArchive(id)) {
+        return true;
+    }
+
+    if (missingTextures.count(id) > 0 || !manifest.hasTexture(id)) {
+        warnMissingTexture(id);
+        return false;
+    }
+
+    requestTexture(id, manifest.getTexturePath(id));
+    return true;
+}
+
+void Renderer::warnMissingTexture(const std::string& id) {
+    if (missingTextures.insert(id).second) {
+        std::cerr << "Texture '" << id << "' not found!" << std::endl;
+    }
+}
+
+void Renderer::renderPlaceholder(const std::string& id, int x, int y, int w, int h) {
+    if (w == 0 || h == 0) {
+        w = 32;
+        h = 32;
+    }
+
+    if (pendingTextures.count(id) > 0) {
+        setDrawColor(64, 64, 64, 255);
+    } else {
+        setDrawColor(255, 0, 255, 255);
+    }
+
+    fillRect(x, y, w, h);
+}
+
 void Renderer::renderTexture(const std::string& id, int x, int y, int w, int h,
                             SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip) {
     auto it  = textureMap.find(id);
     if (it == textureMap.end()) {
-        std::cerr << "Texture '" << id << "' not found!" << std::endl;
+        // Load on first use, the placeholder stands in until the upload lands.
+        requestFromManifest(id);
+        renderPlaceholder(id, x, y, w, h);
         return;
     }
 
-    SDL_Rect destRect = {x, y, w, h};
+    it->second.lastUsedFrame = frameCounter;
+
+    SDL_Rect destRect = {x - viewOffsetX, y - viewOffsetY, w, h};
 
     if (w == 0 || h == 0) {
-        SDL_QueryTexture(it->second, NULL, NULL, &destRect.w, &destRect.h);
+        SDL_QueryTexture(it->second.texture, NULL, NULL, &destRect.w, &destRect.h);
     }
 
-    SDL_RenderCopyEx(renderer, it->second, clip, &destRect, angle, center, flip);
+    SDL_RenderCopyEx(renderer, it->second.texture, clip, &destRect, angle, center, flip);
 }
\ No newline at end of file
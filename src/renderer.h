@@ -6,6 +6,20 @@
 #include <SDL2/SDL_ttf.h>
 #include <string>
 #include <map>
+#include <set>
+#include <vector>
+#include "asset_loader.h"
+#include "asset_manifest.h"
+#include "asset_archive.h"
+
+struct TextureStats {
+    size_t residentBytes;
+    size_t budgetBytes;
+    int residentCount;
+    int pendingCount;
+    int evictionCount;
+    int reloadCount;
+};
 
 class Renderer {
 public:
@@ -24,17 +38,98 @@ public:
     void drawRect(const SDL_Rect& rect);
     void drawText(const std::string& text, int x, int y);
 
+    // World position drawn at the top-left of the screen. Rects and textures
+    // are shifted by it, text is screen space. Reset to 0 before drawing HUD.
+    void setViewOffset(int x, int y) { viewOffsetX = x; viewOffsetY = y; }
+    int getViewOffsetX() const { return viewOffsetX; }
+    int getViewOffsetY() const { return viewOffsetY; }
+
     bool loadTexture(const std::string& id, const std::string& filePath);
+    void requestTexture(const std::string& id, const std::string& filePath);
+    int processLoadedTextures(int maxUploads = -1);
+    bool isLoadingTextures() const { return !assetLoader.isIdle(); }
+    float getLoadProgress() const;
+    bool hasTexture(const std::string& id) const { return textureMap.find(id) != textureMap.end(); }
+
+    bool openArchive(const std::string& filename);
+    bool loadManifest(const std::string& filename);
+    const AssetManifest& getManifest() const { return manifest; }
+
+    // Scene code holds references, textures nobody references can be unloaded.
+    void acquireTexture(const std::string& id);
+    void releaseTexture(const std::string& id);
+    void releaseUnreferencedTextures();
+
+    // Re-decodes a resident texture from disk and swaps it in once uploaded.
+    void reloadTexture(const std::string& id);
+
+    // Least recently drawn textures are evicted once resident textures exceed
+    // the budget, they reload on demand the next time they are drawn.
+    void setTextureBudget(size_t bytes);
+    size_t getTextureBudget() const { return textureBudget; }
+    TextureStats getTextureStats() const;
+
     void renderTexture(const std::string& id, int x, int y, int w = 0, int h = 0,
                         SDL_Rect* clip = nullptr, double andle = 0.0,
                         SDL_Point* center = nullptr, SDL_RendererFlip flip = SDL_FLIP_NONE);
 
     SDL_Renderer* getRenderer() const { return renderer; }
 
+    // Alpha weighted mean of a texture's pixels, recorded whenever it is
+    // uploaded and kept after eviction. The version changes on every update.
+    bool getAverageColor(const std::string& id, SDL_Color& color) const;
+    int getAverageColorVersion() const { return averageColorVersion; }
+
+    // Bumped whenever a texture is uploaded, and separately when a reload
+    // replaces one, so caches of drawn tiles know when to redraw.
+    int getTextureGeneration() const { return textureGeneration; }
+    int getReloadGeneration() const { return reloadGeneration; }
+
 private:
     SDL_Renderer* renderer;
-    std::map<std::string, SDL_Texture*> textureMap;
+    struct TextureEntry {
+        SDL_Texture* texture;
+        size_t bytes;
+        Uint64 lastUsedFrame;
+    };
+
+    std::map<std::string, TextureEntry> textureMap;
     TTF_Font* font;
+    int viewOffsetX, viewOffsetY;
+
+    size_t textureBudget;
+    size_t residentBytes;
+    Uint64 frameCounter;
+    int evictionCount;
+    int reloadCount;
+    std::set<std::string> evictedTextures;
+
+    AssetLoader assetLoader;
+    AssetManifest manifest;
+    AssetArchive archive;
+    bool archiveFormatSupported;
+    std::vector<unsigned char> archiveScratch;
+
+    std::map<std::string, int> textureRefCounts;
+    std::set<std::string> pendingTextures;
+    std::set<std::string> missingTextures;
+    std::set<std::string> reloadingTextures;
+    std::set<std::string> staleArchiveTextures;
+
+    std::map<std::string, SDL_Color> averageColors;
+    int averageColorVersion;
+    int textureGeneration;
+    int reloadGeneration;
+    void recordAverageColor(const std::string& id, SDL_Surface* surface);
+
+    bool createTexture(const std::string& id, SDL_Surface* surface, const std::string& filePath);
+    void addTexture(const std::string& id, SDL_Texture* texture);
+    void destroyTexture(std::map<std::string, TextureEntry>::iterator it);
+    void enforceTextureBudget();
+    bool requestFromManifest(const std::string& id);
+    bool loadTextureFromArchive(const std::string& id);
+    void warnMissingTexture(const std::string& id);
+    void renderPlaceholder(const std::string& id, int x, int y, int w, int h);
 };
 
 
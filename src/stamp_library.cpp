@@ -0,0 +1,63 @@
+#include "stamp_library.h"
+#include "map_serializer.h"
+#include <filesystem>
+#include <iostream>
+
+StampLibrary::StampLibrary() : directory("stamps") {
+}
+
+void StampLibrary::load(const std::string& stampDirectory) {
+    directory = stampDirectory;
+    stamps.clear();
+
+    try {
+        if (!std::filesystem::exists(directory)) return;
+
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() != ".json") continue;
+
+            std::shared_ptr<MapData> data = std::make_shared<MapData>();
+            if (MapSerializer::loadJson(entry.path().string(), *data)) {
+                stamps[entry.path().stem().string()] = data;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading stamps: " << e.what() << std::endl;
+    }
+
+    std::cout << "Loaded " << stamps.size() << " stamps from " << directory << std::endl;
+}
+
+bool StampLibrary::addStamp(const std::string& name, MapChunk chunk) {
+    if (name.empty() || !chunk) return false;
+
+    try {
+        std::filesystem::create_directories(directory);
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving stamp: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (!MapSerializer::saveJson(getStampPath(name), *chunk)) {
+        return false;
+    }
+
+    stamps[name] = chunk;
+    return true;
+}
+
+void StampLibrary::removeStamp(const std::string& name) {
+    stamps.erase(name);
+
+    std::error_code error;
+    std::filesystem::remove(getStampPath(name), error);
+}
+
+MapChunk StampLibrary::getStamp(const std::string& name) const {
+    auto it = stamps.find(name);
+    return it != stamps.end() ? it->second : nullptr;
+}
+
+std::string StampLibrary::getStampPath(const std::string& name) const {
+    return directory + "/" + name + ".json";
+}
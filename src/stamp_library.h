@@ -0,0 +1,29 @@
+#ifndef STAMP_LIBRARY_H
+#define STAMP_LIBRARY_H
+
+#include <string>
+#include <map>
+#include "edit_history.h"
+
+// Reusable blocks of tiles kept as small map files in stamps/. Every stamp is
+// an immutable chunk, placing it any number of times shares the same data.
+class StampLibrary {
+public:
+    StampLibrary();
+
+    void load(const std::string& directory);
+
+    bool addStamp(const std::string& name, MapChunk chunk);
+    void removeStamp(const std::string& name);
+
+    MapChunk getStamp(const std::string& name) const;
+    const std::map<std::string, MapChunk>& getStamps() const { return stamps; }
+
+private:
+    std::string directory;
+    std::map<std::string, MapChunk> stamps;
+
+    std::string getStampPath(const std::string& name) const;
+};
+
+#endif // STAMP_LIBRARY_H
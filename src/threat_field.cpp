@@ -0,0 +1,175 @@
+#include "threat_field.h"
+#include <algorithm>
+
+namespace {
+
+const int NEIGHBOUR_X[4] = {0, 1, 0, -1};
+const int NEIGHBOUR_Y[4] = {-1, 0, 1, 0};
+
+}
+
+ThreatField::ThreatField()
+    : tileMap(nullptr), width(0), height(0), moveRange(0), attackRange(0), nextSourceId(1), expandStamp(0) {
+    dirtyMinX = 0;
+    dirtyMinY = 0;
+    dirtyMaxX = -1;
+    dirtyMaxY = -1;
+}
+
+void ThreatField::reset(const TileMap* tileMap, int moveRange, int attackRange) {
+    this->tileMap = tileMap;
+    this->moveRange = moveRange;
+    this->attackRange = attackRange;
+
+    width = tileMap ? tileMap->getGridWidth() : 0;
+    height = tileMap ? tileMap->getGridHeight() : 0;
+
+    size_t count = static_cast<size_t>(width) * height;
+    counts.assign(count, 0);
+    walkStamps.assign(count, 0);
+    threatStamps.assign(count, 0);
+    expandStamp = 0;
+    sources.clear();
+
+    dirtyMinX = 0;
+    dirtyMinY = 0;
+    dirtyMaxX = width - 1;
+    dirtyMaxY = height - 1;
+}
+
+int ThreatField::addSource(int gridX, int gridY) {
+    int id = nextSourceId++;
+
+    Source& source = sources[id];
+    source.x = gridX;
+    source.y = gridY;
+
+    expand(source);
+    return id;
+}
+
+void ThreatField::moveSource(int id, int gridX, int gridY) {
+    auto it = sources.find(id);
+    if (it == sources.end()) return;
+
+    Source& source = it->second;
+    if (source.x == gridX && source.y == gridY) return;
+
+    retract(source);
+    source.x = gridX;
+    source.y = gridY;
+    expand(source);
+}
+
+void ThreatField::removeSource(int id) {
+    auto it = sources.find(id);
+    if (it == sources.end()) return;
+
+    retract(it->second);
+    sources.erase(it);
+}
+
+int ThreatField::getThreat(int gridX, int gridY) const {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) {
+        return 0;
+    }
+
+    return counts[static_cast<size_t>(gridY) * width + gridX];
+}
+
+bool ThreatField::takeDirtyRect(SDL_Rect& rect) {
+    if (dirtyMinX > dirtyMaxX || dirtyMinY > dirtyMaxY) {
+        return false;
+    }
+
+    rect = {dirtyMinX, dirtyMinY, dirtyMaxX - dirtyMinX + 1, dirtyMaxY - dirtyMinY + 1};
+
+    dirtyMinX = width;
+    dirtyMinY = height;
+    dirtyMaxX = -1;
+    dirtyMaxY = -1;
+    return true;
+}
+
+void ThreatField::retract(Source& source) {
+    for (int i : source.tiles) {
+        counts[i]--;
+    }
+    source.tiles.clear();
+    markDirty(source);
+}
+
+// Breadth first over walkable tiles for the move, then over every tile for
+// the attack, so both ranges are exact step counts.
+void ThreatField::expand(Source& source) {
+    if (!tileMap || source.x < 0 || source.x >= width || source.y < 0 || source.y >= height) return;
+
+    // Wrapping around resets the stamps so old ones can't collide.
+    if (++expandStamp == 0) {
+        std::fill(walkStamps.begin(), walkStamps.end(), 0);
+        std::fill(threatStamps.begin(), threatStamps.end(), 0);
+        expandStamp = 1;
+    }
+
+    int start = source.y * width + source.x;
+    walkStamps[start] = expandStamp;
+    reached.assign(1, start);
+    frontier.assign(1, start);
+
+    for (int step = 0; step < moveRange && !frontier.empty(); step++) {
+        next.clear();
+        for (int cell : frontier) {
+            for (int i = 0; i < 4; i++) {
+                int x = cell % width + NEIGHBOUR_X[i];
+                int y = cell / width + NEIGHBOUR_Y[i];
+                if (!tileMap->isWalkable(x, y)) continue;
+
+                int neighbour = y * width + x;
+                if (walkStamps[neighbour] == expandStamp) continue;
+
+                walkStamps[neighbour] = expandStamp;
+                next.push_back(neighbour);
+                reached.push_back(neighbour);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    for (int cell : reached) {
+        threatStamps[cell] = expandStamp;
+        source.tiles.push_back(cell);
+    }
+    frontier = reached;
+
+    for (int step = 0; step < attackRange && !frontier.empty(); step++) {
+        next.clear();
+        for (int cell : frontier) {
+            for (int i = 0; i < 4; i++) {
+                int x = cell % width + NEIGHBOUR_X[i];
+                int y = cell / width + NEIGHBOUR_Y[i];
+                if (x < 0 || x >= width || y < 0 || y >= height) continue;
+
+                int neighbour = y * width + x;
+                if (threatStamps[neighbour] == expandStamp) continue;
+
+                threatStamps[neighbour] = expandStamp;
+                next.push_back(neighbour);
+                source.tiles.push_back(neighbour);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    for (int i : source.tiles) {
+        counts[i]++;
+    }
+    markDirty(source);
+}
+
+void ThreatField::markDirty(const Source& source) {
+    int radius = moveRange + attackRange;
+    dirtyMinX = std::max(0, std::min(dirtyMinX, source.x - radius));
+    dirtyMinY = std::max(0, std::min(dirtyMinY, source.y - radius));
+    dirtyMaxX = std::min(width - 1, std::max(dirtyMaxX, source.x + radius));
+    dirtyMaxY = std::min(height - 1, std::max(dirtyMaxY, source.y + radius));
+}
@@ -0,0 +1,71 @@
+#ifndef THREAT_FIELD_H
+#define THREAT_FIELD_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "tilemap.h"
+
+// For every tile, how many enemies could attack it next turn: walk up to
+// moveRange steps over walkable tiles, then strike anything within
+// attackRange (Manhattan) of where they stopped.
+//
+// Each source keeps the list of tiles it threatens and every tile counts the
+// sources threatening it, like VisibilityField does for viewers. Moving or
+// removing a source retracts its old tiles and expands only that source
+// again, the rest of the field is left alone. There is no limit on sources.
+class ThreatField {
+public:
+    ThreatField();
+
+    // Drops all sources and sizes the field to the map.
+    void reset(const TileMap* tileMap, int moveRange, int attackRange);
+
+    // Returns an id for moveSource and removeSource.
+    int addSource(int gridX, int gridY);
+    void moveSource(int id, int gridX, int gridY);
+    void removeSource(int id);
+    int getSourceCount() const { return static_cast<int>(sources.size()); }
+
+    // Number of sources that can attack the tile.
+    int getThreat(int gridX, int gridY) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Bounding box of tiles whose threat changed since the last call.
+    bool takeDirtyRect(SDL_Rect& rect);
+
+private:
+    struct Source {
+        int x, y;
+        std::vector<int> tiles;
+    };
+
+    const TileMap* tileMap;
+    int width, height;
+    int moveRange, attackRange;
+
+    std::vector<uint16_t> counts;
+    std::map<int, Source> sources;
+    int nextSourceId;
+
+    // Scratch for expand(), tiles stamped by the current expansion are not
+    // visited twice. Kept between calls so nothing is allocated per step.
+    std::vector<uint32_t> walkStamps;
+    std::vector<uint32_t> threatStamps;
+    uint32_t expandStamp;
+    std::vector<int> reached;
+    std::vector<int> frontier;
+    std::vector<int> next;
+
+    int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+
+    void expand(Source& source);
+    void retract(Source& source);
+    void markDirty(const Source& source);
+};
+
+#endif // THREAT_FIELD_H
@@ -0,0 +1,100 @@
+#include "threat_overlay.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+const Uint32 THREAT_COLOR = 0x00FF5020u;
+const int THREAT_ALPHA_STEP = 40;
+const int THREAT_ALPHA_MAX = 160;
+
+}
+
+ThreatOverlay::ThreatOverlay()
+    : texture(nullptr), width(0), height(0), tileSize(0), source(nullptr), visibility(nullptr), visibilityRevision(0) {
+}
+
+ThreatOverlay::~ThreatOverlay() {
+    destroy();
+}
+
+void ThreatOverlay::destroy() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    width = 0;
+    height = 0;
+    source = nullptr;
+}
+
+void ThreatOverlay::update(Renderer& renderer, ThreatField& field, const TileMap* tileMap) {
+    if (!renderer.getRenderer() || !tileMap) return;
+
+    SDL_Rect dirty;
+    bool hasDirty = field.takeDirtyRect(dirty);
+
+    if (field.getWidth() == 0 || field.getHeight() == 0) {
+        source = nullptr;
+        return;
+    }
+
+    bool resized = width != field.getWidth() || height != field.getHeight();
+    if (!texture || resized) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+        }
+
+        width = field.getWidth();
+        height = field.getHeight();
+        texture = SDL_CreateTexture(renderer.getRenderer(), SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!texture) {
+            std::cerr << "Failed to create threat texture: " << SDL_GetError() << std::endl;
+            width = 0;
+            height = 0;
+            return;
+        }
+
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    }
+
+    tileSize = tileMap->getTileSize();
+
+    const VisibilityField& sight = tileMap->getVisibility();
+    if (&field != source || &sight != visibility || sight.getRevision() != visibilityRevision || resized) {
+        source = &field;
+        visibility = &sight;
+        visibilityRevision = sight.getRevision();
+        uploadRect({0, 0, width, height});
+    } else if (hasDirty) {
+        uploadRect(dirty);
+    }
+}
+
+void ThreatOverlay::uploadRect(const SDL_Rect& rect) {
+    texels.resize(static_cast<size_t>(rect.w) * rect.h);
+
+    for (int y = 0; y < rect.h; y++) {
+        for (int x = 0; x < rect.w; x++) {
+            int threat = source->getThreat(rect.x + x, rect.y + y);
+            if (visibility->hasViewers() && !visibility->isVisible(rect.x + x, rect.y + y)) {
+                threat = 0;
+            }
+
+            Uint32 alpha = static_cast<Uint32>(std::min(THREAT_ALPHA_MAX, threat * THREAT_ALPHA_STEP));
+
+            texels[static_cast<size_t>(y) * rect.w + x] = threat > 0 ? (alpha << 24) | THREAT_COLOR : 0;
+        }
+    }
+
+    SDL_UpdateTexture(texture, &rect, texels.data(), rect.w * sizeof(Uint32));
+}
+
+void ThreatOverlay::render(Renderer& renderer) {
+    if (!texture || !source) return;
+
+    SDL_Rect destRect = {-renderer.getViewOffsetX(), -renderer.getViewOffsetY(), width * tileSize, height * tileSize};
+    SDL_RenderCopy(renderer.getRenderer(), texture, nullptr, &destRect);
+}
@@ -0,0 +1,40 @@
+#ifndef THREAT_OVERLAY_H
+#define THREAT_OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "renderer.h"
+#include "threat_field.h"
+#include "tilemap.h"
+
+// Tints tiles by how many enemies can attack them, one texel per tile like
+// FogOverlay. Only the threat field's dirty rect is re-uploaded, so an enemy
+// stepping costs a few rows of texels however large the arena is.
+//
+// Tiles out of sight stay clear, otherwise threat would show through the
+// remembered fog and give away hidden enemies. The whole texture is redrawn
+// when sight changes, which only happens when the player steps.
+class ThreatOverlay {
+public:
+    ThreatOverlay();
+    ~ThreatOverlay();
+
+    void update(Renderer& renderer, ThreatField& field, const TileMap* tileMap);
+    void render(Renderer& renderer);
+
+    void destroy();
+
+private:
+    SDL_Texture* texture;
+    int width, height;
+    int tileSize;
+    const ThreatField* source;
+    const VisibilityField* visibility;
+    uint32_t visibilityRevision;
+
+    std::vector<Uint32> texels;
+
+    void uploadRect(const SDL_Rect& rect);
+};
+
+#endif // THREAT_OVERLAY_H
@@ -0,0 +1,198 @@
+#include "tile_layer.h"
+#include <algorithm>
+#include <iostream>
+
+TileLayer::TileLayer(const std::string& name, TileLayerKind kind, int width, int height, int tileSize)
+    : name(name), kind(kind), width(width), height(height), tileSize(tileSize),
+      cells(static_cast<size_t>(width) * height, kind == TileLayerKind::COLLISION ? 1 : 0),
+      visible(true), opacity(255), reloadGeneration(0) {
+
+    chunksX = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunksY = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunks.resize(static_cast<size_t>(chunksX) * chunksY);
+}
+
+TileLayer::~TileLayer() {
+    releaseCache();
+}
+
+uint16_t TileLayer::get(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return 0;
+    }
+
+    return cells[static_cast<size_t>(y) * width + x];
+}
+
+bool TileLayer::set(int x, int y, uint16_t value) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return false;
+    }
+
+    uint16_t& cell = cells[static_cast<size_t>(y) * width + x];
+    if (cell == value) {
+        return false;
+    }
+
+    cell = value;
+    markChunkDirty(x, y);
+    return true;
+}
+
+void TileLayer::fill(uint16_t value) {
+    std::fill(cells.begin(), cells.end(), value);
+    invalidate();
+}
+
+void TileLayer::assign(const std::vector<uint16_t>& values) {
+    if (values.size() != cells.size()) {
+        std::cerr << "Layer " << name << " expects " << cells.size() << " cells, got " << values.size() << std::endl;
+        return;
+    }
+
+    cells = values;
+    invalidate();
+}
+
+void TileLayer::invalidate() {
+    for (auto& chunk : chunks) {
+        chunk.dirty = true;
+    }
+}
+
+void TileLayer::releaseCache() {
+    for (auto& chunk : chunks) {
+        if (chunk.texture) {
+            SDL_DestroyTexture(chunk.texture);
+            chunk.texture = nullptr;
+        }
+        chunk.dirty = true;
+    }
+}
+
+void TileLayer::markChunkDirty(int x, int y) {
+    chunks[static_cast<size_t>(y / CHUNK_TILES) * chunksX + x / CHUNK_TILES].dirty = true;
+}
+
+SDL_Rect TileLayer::getChunkRect(int chunkX, int chunkY) const {
+    int x = chunkX * CHUNK_TILES;
+    int y = chunkY * CHUNK_TILES;
+    return {x, y, std::min(CHUNK_TILES, width - x), std::min(CHUNK_TILES, height - y)};
+}
+
+void TileLayer::render(Renderer& renderer, const std::vector<std::string>& palette, const SDL_Rect& view) {
+    if (!visible || opacity == 0 || chunks.empty()) return;
+
+    int firstX = std::max(0, view.x / tileSize);
+    int firstY = std::max(0, view.y / tileSize);
+    int lastX = std::min(width, (view.x + view.w + tileSize - 1) / tileSize);
+    int lastY = std::min(height, (view.y + view.h + tileSize - 1) / tileSize);
+    if (firstX >= lastX || firstY >= lastY) return;
+
+    SDL_Renderer* sdlRenderer = renderer.getRenderer();
+    if (!SDL_RenderTargetSupported(sdlRenderer)) {
+        drawCells(renderer, palette, firstX, firstY, lastX, lastY);
+        return;
+    }
+
+    if (reloadGeneration != renderer.getReloadGeneration()) {
+        reloadGeneration = renderer.getReloadGeneration();
+        invalidate();
+    }
+
+    for (int chunkY = firstY / CHUNK_TILES; chunkY <= (lastY - 1) / CHUNK_TILES; chunkY++) {
+        for (int chunkX = firstX / CHUNK_TILES; chunkX <= (lastX - 1) / CHUNK_TILES; chunkX++) {
+            Chunk& chunk = chunks[static_cast<size_t>(chunkY) * chunksX + chunkX];
+            SDL_Rect area = getChunkRect(chunkX, chunkY);
+
+            if (!chunk.texture) {
+                chunk.texture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                                  area.w * tileSize, area.h * tileSize);
+                if (!chunk.texture) {
+                    std::cerr << "Failed to create layer cache for " << name << ": " << SDL_GetError() << std::endl;
+                    drawCells(renderer, palette, area.x, area.y, area.x + area.w, area.y + area.h);
+                    continue;
+                }
+
+                SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+                chunk.dirty = true;
+            }
+
+            if (chunk.dirty || (!chunk.complete && chunk.textureGeneration != renderer.getTextureGeneration())) {
+                bakeChunk(renderer, palette, chunkX, chunkY, chunk);
+            }
+
+            SDL_Rect destRect = {area.x * tileSize - renderer.getViewOffsetX(),
+                                 area.y * tileSize - renderer.getViewOffsetY(),
+                                 area.w * tileSize, area.h * tileSize};
+
+            SDL_SetTextureAlphaMod(chunk.texture, opacity);
+            SDL_RenderCopy(sdlRenderer, chunk.texture, nullptr, &destRect);
+        }
+    }
+}
+
+void TileLayer::bakeChunk(Renderer& renderer, const std::vector<std::string>& palette, int chunkX, int chunkY, Chunk& chunk) {
+    SDL_Renderer* sdlRenderer = renderer.getRenderer();
+    SDL_Rect area = getChunkRect(chunkX, chunkY);
+
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(sdlRenderer);
+    if (SDL_SetRenderTarget(sdlRenderer, chunk.texture) != 0) {
+        std::cerr << "Failed to draw layer cache for " << name << ": " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    SDL_SetRenderDrawColor(sdlRenderer, 0, 0, 0, 0);
+    SDL_RenderClear(sdlRenderer);
+
+    // The chunk's top-left corner becomes the view origin while drawing into it.
+    int viewOffsetX = renderer.getViewOffsetX();
+    int viewOffsetY = renderer.getViewOffsetY();
+    renderer.setViewOffset(area.x * tileSize, area.y * tileSize);
+
+    chunk.complete = drawCells(renderer, palette, area.x, area.y, area.x + area.w, area.y + area.h);
+
+    renderer.setViewOffset(viewOffsetX, viewOffsetY);
+    SDL_SetRenderTarget(sdlRenderer, previousTarget);
+
+    chunk.dirty = false;
+    chunk.textureGeneration = renderer.getTextureGeneration();
+}
+
+bool TileLayer::drawCells(Renderer& renderer, const std::vector<std::string>& palette,
+                          int firstX, int firstY, int lastX, int lastY) {
+    bool complete = true;
+
+    for (int y = firstY; y < lastY; y++) {
+        for (int x = firstX; x < lastX; x++) {
+            uint16_t value = cells[static_cast<size_t>(y) * width + x];
+            int pixelX = x * tileSize;
+            int pixelY = y * tileSize;
+
+            if (kind == TileLayerKind::COLLISION) {
+                if (value == 0) {
+                    renderer.setDrawColor(255, 0, 0, 100);
+                    renderer.drawRect(pixelX, pixelY, tileSize, tileSize);
+                }
+                continue;
+            }
+
+            if (value == 0 || value >= palette.size()) {
+                if (kind == TileLayerKind::GROUND) {
+                    renderer.setDrawColor(40, 40, 40, 255);
+                    renderer.fillRect(pixelX, pixelY, tileSize, tileSize);
+                }
+                continue;
+            }
+
+            // Archived textures upload during the call, so check afterwards.
+            const std::string& textureID = palette[value];
+            renderer.renderTexture(textureID, pixelX, pixelY, tileSize, tileSize);
+            if (!renderer.hasTexture(textureID)) {
+                complete = false;
+            }
+        }
+    }
+
+    return complete;
+}
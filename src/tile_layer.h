@@ -0,0 +1,89 @@
+#ifndef TILE_LAYER_H
+#define TILE_LAYER_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "renderer.h"
+
+enum class TileLayerKind {
+    GROUND,     // palette indices, empty cells are drawn as a dark floor
+    TEXTURE,    // palette indices, empty cells are see-through
+    COLLISION   // 1 walkable, 0 blocked, blocked cells get a red outline
+};
+
+// One layer of a TileMap: a flat grid of cells plus how it is drawn.
+//
+// Drawn tiles are cached in render target textures of CHUNK_TILES x
+// CHUNK_TILES tiles, created the first time a chunk is on screen. Setting a
+// cell only marks its own chunk for redrawing, so edits to one layer never
+// touch the caches of the others. Chunks drawn while a texture was still
+// loading are redrawn once new textures arrive, and every chunk is redrawn
+// after a hot reload. Without render target support cells are drawn
+// directly each frame and opacity is ignored.
+class TileLayer {
+public:
+    static const int CHUNK_TILES = 16;
+
+    TileLayer(const std::string& name, TileLayerKind kind, int width, int height, int tileSize);
+    ~TileLayer();
+
+    const std::string& getName() const { return name; }
+    void setName(const std::string& newName) { name = newName; }
+    TileLayerKind getKind() const { return kind; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Out of range reads return 0, writes are ignored. set() returns false
+    // when the cell already held the value.
+    uint16_t get(int x, int y) const;
+    bool set(int x, int y, uint16_t value);
+    void fill(uint16_t value);
+    void assign(const std::vector<uint16_t>& values);
+    const std::vector<uint16_t>& getCells() const { return cells; }
+
+    bool isVisible() const { return visible; }
+    void setVisible(bool value) { visible = value; }
+    Uint8 getOpacity() const { return opacity; }
+    void setOpacity(Uint8 value) { opacity = value; }
+
+    // view is in world pixels, palette maps cell values to texture ids.
+    void render(Renderer& renderer, const std::vector<std::string>& palette, const SDL_Rect& view);
+
+    // Redraw every chunk next frame, e.g. after the render targets were lost.
+    void invalidate();
+    void releaseCache();
+
+private:
+    struct Chunk {
+        SDL_Texture* texture = nullptr;
+        bool dirty = true;
+        // False when a texture was missing while drawing.
+        bool complete = false;
+        int textureGeneration = -1;
+    };
+
+    std::string name;
+    TileLayerKind kind;
+    int width, height;
+    int tileSize;
+    std::vector<uint16_t> cells;
+
+    bool visible;
+    Uint8 opacity;
+
+    int chunksX, chunksY;
+    std::vector<Chunk> chunks;
+    int reloadGeneration;
+
+    void markChunkDirty(int x, int y);
+    void bakeChunk(Renderer& renderer, const std::vector<std::string>& palette, int chunkX, int chunkY, Chunk& chunk);
+    SDL_Rect getChunkRect(int chunkX, int chunkY) const;
+
+    // Returns false when any texture was not resident yet.
+    bool drawCells(Renderer& renderer, const std::vector<std::string>& palette,
+                   int firstX, int firstY, int lastX, int lastY);
+};
+
+#endif // TILE_LAYER_H
@@ -0,0 +1,88 @@
+#include "tile_overlay.h"
+#include <iostream>
+
+TileOverlay::TileOverlay(const std::string& textureID, SDL_Color fallbackColor)
+    : textureID(textureID), color(fallbackColor), colorFromTexture(false),
+      texture(nullptr), width(0), height(0), tileSize(0), visible(false) {
+}
+
+TileOverlay::~TileOverlay() {
+    destroy();
+}
+
+void TileOverlay::destroy() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    width = 0;
+    height = 0;
+    tiles.clear();
+}
+
+void TileOverlay::setTiles(Renderer& renderer, const TileMap* tileMap, const std::vector<std::pair<int, int>>& newTiles) {
+    visible = true;
+
+    bool resized = width != tileMap->getGridWidth() || height != tileMap->getGridHeight();
+    tileSize = tileMap->getTileSize();
+
+    // Keep the texture's alpha, the highlight stays see-through.
+    SDL_Color average;
+    bool recolored = false;
+    if (!colorFromTexture && renderer.getAverageColor(textureID, average)) {
+        color = {average.r, average.g, average.b, color.a};
+        colorFromTexture = true;
+        recolored = true;
+    }
+
+    if (!resized && !recolored && texture && newTiles == tiles) {
+        return;
+    }
+
+    if (!texture || resized) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+        }
+
+        width = tileMap->getGridWidth();
+        height = tileMap->getGridHeight();
+        texture = SDL_CreateTexture(renderer.getRenderer(), SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!texture) {
+            std::cerr << "Failed to create overlay texture: " << SDL_GetError() << std::endl;
+            width = 0;
+            height = 0;
+            return;
+        }
+
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    }
+
+    tiles = newTiles;
+    upload();
+}
+
+void TileOverlay::clear() {
+    visible = false;
+}
+
+void TileOverlay::upload() {
+    Uint32 texel = (static_cast<Uint32>(color.a) << 24) | (color.r << 16) | (color.g << 8) | color.b;
+
+    texels.assign(static_cast<size_t>(width) * height, 0);
+    for (const auto& tile : tiles) {
+        if (tile.first >= 0 && tile.first < width && tile.second >= 0 && tile.second < height) {
+            texels[static_cast<size_t>(tile.second) * width + tile.first] = texel;
+        }
+    }
+
+    SDL_UpdateTexture(texture, nullptr, texels.data(), width * sizeof(Uint32));
+}
+
+void TileOverlay::render(Renderer& renderer) {
+    if (!visible || !texture || tiles.empty()) return;
+
+    SDL_Rect destRect = {-renderer.getViewOffsetX(), -renderer.getViewOffsetY(), width * tileSize, height * tileSize};
+    SDL_RenderCopy(renderer.getRenderer(), texture, nullptr, &destRect);
+}
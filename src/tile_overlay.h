@@ -0,0 +1,43 @@
+#ifndef TILE_OVERLAY_H
+#define TILE_OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "renderer.h"
+#include "tilemap.h"
+
+// Highlights a set of tiles with one texel per tile, stretched over the map
+// with nearest filtering. The texture is only rewritten when the tile set
+// changes, drawing it is a single copy however many tiles are lit.
+class TileOverlay {
+public:
+    // textureID is the highlight texture the overlay stands in for, its
+    // averaged colour becomes the texel colour once it has been uploaded.
+    TileOverlay(const std::string& textureID, SDL_Color fallbackColor);
+    ~TileOverlay();
+
+    void setTiles(Renderer& renderer, const TileMap* tileMap, const std::vector<std::pair<int, int>>& tiles);
+    void clear();
+
+    void render(Renderer& renderer);
+
+    void destroy();
+
+private:
+    std::string textureID;
+    SDL_Color color;
+    bool colorFromTexture;
+
+    SDL_Texture* texture;
+    int width, height;
+    int tileSize;
+
+    std::vector<std::pair<int, int>> tiles;
+    std::vector<Uint32> texels;
+    bool visible;
+
+    void upload();
+};
+
+#endif // TILE_OVERLAY_H
@@ -3,76 +3,41 @@
 #include <algorithm>
 #include <cmath>
 
-// global for now
-
-TileMap* g_TileMap = nullptr;
-
 TileMap::TileMap(int tileSize, int windowWidth, int windowHeight)
-    : tileSize(tileSize), windowWidth(windowWidth), windowHeight(windowHeight) {
+    : tileSize(tileSize), windowWidth(windowWidth), windowHeight(windowHeight), viewX(0), viewY(0), autotiled(false) {
 
     gridWidth = windowWidth / tileSize;
     gridHeight = windowHeight / tileSize;
 
-    g_TileMap = this;
+    layers.push_back(new TileLayer("Ground", TileLayerKind::GROUND, gridWidth, gridHeight, tileSize));
+    layers.push_back(new TileLayer("Objects", TileLayerKind::TEXTURE, gridWidth, gridHeight, tileSize));
+    layers.push_back(new TileLayer("Collision", TileLayerKind::COLLISION, gridWidth, gridHeight, tileSize));
+
+    internTexture("");
+    visibility.resize(gridWidth, gridHeight);
+    markAllDirty();
 }
 
 TileMap::~TileMap() {
-    for (auto& row : tiles) {
-        for (auto& tile : row) {
-            delete tile;
-        }
-    }
-
-    if (g_TileMap == this) {
-        g_TileMap = nullptr;
+    for (auto layer : layers) {
+        delete layer;
     }
 }
 
 void TileMap::initialize() {
-    tiles.resize(gridHeight);
-
-    for (int y = 0; y < gridHeight; y++) {
-        tiles[y].resize(gridWidth);
-
-        for (int x = 0; x < gridWidth; x++) {
-            tiles[y][x] = new Tile(x, y);
-
-            tiles[y][x]->setProperty("walkable", true);
-
-            tiles[y][x]->setProperty("textureID", "tile_grass");
-        }
-    }
+    getGroundLayer()->fill(internTexture("tile_grass"));
+    getObjectLayer()->fill(0);
+    getCollisionLayer()->fill(1);
+    markAllDirty();
 
     std::cout << "Empty TileMap initialized with " << gridWidth << "x" << gridHeight << " tiles (" << tileSize << "px each)" << std::endl;
 }
 
 void TileMap::render(Renderer& renderer) {
-    for (int y = 0; y < gridHeight; y++) {
-        for (int x = 0; x < gridWidth; x++) {
-            Tile* tile = tiles[y][x];
-            if (tile) {
-                int pixelX = x * tileSize;
-                int pixelY = y * tileSize;
-
-                std::string textureID = tile->getProperty<std::string>("textureID", "");
-                if (!textureID.empty()) {
-                    renderer.renderTexture(textureID, pixelX, pixelY, tileSize, tileSize);
-                } else {
-                    renderer.setDrawColor(40, 40, 40, 255);
-                    renderer.fillRect(pixelX, pixelY, tileSize, tileSize);
-                }
-
-                std::string objectTextureID = tile->getProperty<std::string>("objectTexture", "");
-                if (!objectTextureID.empty()) {
-                    renderer.renderTexture(objectTextureID, pixelX, pixelY, tileSize, tileSize);
-                }
-
-                if (!tile->getProperty("walkable", true)) {
-                    renderer.setDrawColor(255, 0, 0, 100);
-                    renderer.drawRect(pixelX, pixelY, tileSize, tileSize);
-                }
-            }
-        }
+    SDL_Rect view = {viewX, viewY, windowWidth, windowHeight};
+
+    for (auto layer : layers) {
+        layer->render(renderer, palette, view);
     }
 }
 
@@ -86,14 +51,6 @@ void TileMap::gridToPixel(int gridX, int gridY, int& pixelX, int& pixelY) const
     pixelY = gridY * tileSize;
 }
 
-Tile* TileMap::getTileAt(int gridX, int gridY) {
-    if (isValidGridPosition(gridX, gridY)) {
-        return tiles[gridY][gridX];
-    }
-
-    return nullptr;
-}
-
 bool TileMap::isValidGridPosition(int gridX, int gridY) const {
     return gridX >= 0 && gridX < gridWidth && gridY >= 0 && gridY < gridHeight;
 }
@@ -103,15 +60,13 @@ bool TileMap::isWalkable(int gridX, int gridY) const {
         return false;
     }
 
-    return tiles[gridY][gridX]->getProperty("walkable", false);
+    return getCollisionLayer()->get(gridX, gridY) != 0;
 }
 
 std::vector<std::pair<int, int>> TileMap::findPath(int startX, int startY, int endX, int endY) const {
     std::vector<std::pair<int, int>> path;
 
-    if (!isValidGridPosition(startX, startY) || !isValidGridPosition(endX, endY) ||
-        !tiles[startY][startX]->getProperty("walkable", false) ||
-        !tiles[endY][endX]->getProperty("walkable", false)) {
+    if (!isWalkable(startX, startY) || !isWalkable(endX, endY)) {
                 return path;
         }
 
@@ -160,8 +115,7 @@ std::vector<std::pair<int, int>> TileMap::findPath(int startX, int startY, int e
             int neighborX = current->x + dx[i];
             int neighborY = current->y + dy[i];
 
-            if (!isValidGridPosition(neighborX, neighborY) ||
-                !tiles[neighborY][neighborX]->getProperty("walkable", false) ||
+            if (!isWalkable(neighborX, neighborY) ||
                 isInList(closedList, neighborX, neighborY)) {
                     continue;
             }
@@ -210,8 +164,279 @@ TileMap::PathNode* TileMap::getNodeFromList(std::vector<PathNode*>& list, int x,
     return (it != list.end()) ? *it : nullptr;
 }
 
+TileLayer* TileMap::getDecorationLayer(int index) const {
+    if (index < 0 || index >= getDecorationCount()) {
+        return nullptr;
+    }
+
+    return layers[2 + index];
+}
+
+TileLayer* TileMap::findLayer(const std::string& name) const {
+    for (auto layer : layers) {
+        if (layer->getName() == name) return layer;
+    }
+
+    return nullptr;
+}
+
+TileLayer* TileMap::findDecorationLayer(const std::string& name) const {
+    for (int i = 0; i < getDecorationCount(); i++) {
+        if (layers[2 + i]->getName() == name) return layers[2 + i];
+    }
+
+    return nullptr;
+}
+
+TileLayer* TileMap::addDecorationLayer(const std::string& name) {
+    if (name.empty() || findLayer(name) || getDecorationCount() >= MAX_DECORATION_LAYERS) {
+        return nullptr;
+    }
+
+    TileLayer* layer = new TileLayer(name, TileLayerKind::TEXTURE, gridWidth, gridHeight, tileSize);
+    layers.insert(layers.end() - 1, layer);
+    return layer;
+}
+
+void TileMap::removeDecorationLayer(int index) {
+    TileLayer* layer = getDecorationLayer(index);
+    if (!layer) return;
+
+    layers.erase(layers.begin() + 2 + index);
+    delete layer;
+    markAllDirty();
+}
+
+uint16_t TileMap::internTexture(const std::string& textureID) {
+    auto it = paletteLookup.find(textureID);
+    if (it != paletteLookup.end()) {
+        return it->second;
+    }
+
+    uint16_t paletteIndex = static_cast<uint16_t>(palette.size());
+    palette.push_back(textureID);
+    paletteLookup[textureID] = paletteIndex;
+    return paletteIndex;
+}
+
+const std::string& TileMap::getTexture(uint16_t paletteIndex) const {
+    if (paletteIndex < palette.size()) {
+        return palette[paletteIndex];
+    }
+
+    return palette[0];
+}
+
+const std::string& TileMap::getGroundTexture(int gridX, int gridY) const {
+    return getTexture(getGroundLayer()->get(gridX, gridY));
+}
+
+const std::string& TileMap::getObjectTexture(int gridX, int gridY) const {
+    return getTexture(getObjectLayer()->get(gridX, gridY));
+}
+
 void TileMap::setTileTexture(int gridX, int gridY, const std::string& textureID) {
-    if (isValidGridPosition(gridX, gridY)) {
-        tiles[gridY][gridX]->setProperty("textureID", textureID);
+    setCell(getGroundLayer(), gridX, gridY, internTexture(textureID));
+}
+
+void TileMap::setObjectTexture(int gridX, int gridY, const std::string& textureID) {
+    setCell(getObjectLayer(), gridX, gridY, internTexture(textureID));
+}
+
+void TileMap::setWalkable(int gridX, int gridY, bool walkable) {
+    setCell(getCollisionLayer(), gridX, gridY, walkable ? 1 : 0);
+}
+
+void TileMap::setCell(TileLayer* layer, int gridX, int gridY, uint16_t value) {
+    if (!layer->set(gridX, gridY, value)) return;
+
+    markDirty(gridX, gridY);
+    if (layer == getCollisionLayer() && visibility.hasViewers()) {
+        visibility.blockerChanged(gridX, gridY, *layer);
     }
-}
\ No newline at end of file
+}
+
+int TileMap::addViewer(int gridX, int gridY, int radius) {
+    return visibility.addViewer(gridX, gridY, radius, *getCollisionLayer());
+}
+
+void TileMap::moveViewer(int id, int gridX, int gridY) {
+    visibility.moveViewer(id, gridX, gridY, *getCollisionLayer());
+}
+
+void TileMap::removeViewer(int id) {
+    visibility.removeViewer(id);
+}
+
+void TileMap::clearVisibility() {
+    visibility.clear();
+}
+
+void TileMap::releaseRenderCache() {
+    for (auto layer : layers) {
+        layer->releaseCache();
+    }
+}
+
+void TileMap::invalidateRenderCache() {
+    for (auto layer : layers) {
+        layer->invalidate();
+    }
+}
+
+void TileMap::applyMapData(const MapData& data) {
+    while (getDecorationCount() > 0) {
+        removeDecorationLayer(getDecorationCount() - 1);
+    }
+
+    // Names clashing with a base layer are skipped, never written over it.
+    std::vector<TileLayer*> decorationLayers;
+    for (const auto& decoration : data.decorations) {
+        TileLayer* layer = addDecorationLayer(decoration.name);
+        if (!layer) {
+            std::cerr << "Skipping decoration layer '" << decoration.name << "'" << std::endl;
+        }
+        decorationLayers.push_back(layer);
+    }
+
+    // Map palette indices are translated once, not per tile.
+    std::vector<uint16_t> remap(data.palette.size());
+    for (size_t i = 0; i < data.palette.size(); i++) {
+        remap[i] = internTexture(data.palette[i]);
+    }
+    auto translate = [&remap](uint16_t value) -> uint16_t {
+        return value < remap.size() ? remap[value] : 0;
+    };
+
+    std::vector<uint16_t> ground(static_cast<size_t>(gridWidth) * gridHeight, 0);
+    std::vector<uint16_t> objects(ground.size(), 0);
+    std::vector<uint16_t> walkable(ground.size(), 1);
+
+    for (int y = 0; y < gridHeight; y++) {
+        for (int x = 0; x < gridWidth; x++) {
+            if (!data.contains(x, y)) continue;
+
+            int i = data.index(x, y);
+            size_t cell = static_cast<size_t>(y) * gridWidth + x;
+            ground[cell] = translate(data.ground[i]);
+            objects[cell] = translate(data.objects[i]);
+            walkable[cell] = data.walkable[i] != 0 ? 1 : 0;
+        }
+    }
+
+    getGroundLayer()->assign(ground);
+    getObjectLayer()->assign(objects);
+    getCollisionLayer()->assign(walkable);
+    visibility.clear();
+    autotiled = data.autotile;
+
+    for (size_t d = 0; d < data.decorations.size(); d++) {
+        const MapDataLayer& decoration = data.decorations[d];
+        TileLayer* layer = decorationLayers[d];
+        if (!layer) continue;
+
+        std::vector<uint16_t> tiles(ground.size(), 0);
+        for (int y = 0; y < std::min(gridHeight, data.height); y++) {
+            for (int x = 0; x < std::min(gridWidth, data.width); x++) {
+                tiles[static_cast<size_t>(y) * gridWidth + x] = translate(decoration.tiles[data.index(x, y)]);
+            }
+        }
+        layer->assign(tiles);
+    }
+
+    markAllDirty();
+}
+
+void TileMap::copyRegion(int x, int y, int width, int height, MapData& data) const {
+    data.clearPalette();
+    data.tileSize = tileSize;
+    data.decorations.clear();
+    for (int i = 0; i < getDecorationCount(); i++) {
+        data.decorations.push_back({getDecorationLayer(i)->getName(), {}});
+    }
+    data.resize(width, height);
+
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            if (!isValidGridPosition(x + column, y + row)) continue;
+
+            int i = data.index(column, row);
+            data.walkable[i] = isWalkable(x + column, y + row) ? 1 : 0;
+            data.ground[i] = data.internTexture(getGroundTexture(x + column, y + row));
+            data.objects[i] = data.internTexture(getObjectTexture(x + column, y + row));
+
+            for (int layer = 0; layer < getDecorationCount(); layer++) {
+                data.decorations[layer].tiles[i] =
+                    data.internTexture(getTexture(getDecorationLayer(layer)->get(x + column, y + row)));
+            }
+        }
+    }
+}
+
+void TileMap::pasteRegion(int x, int y, const MapData& data) {
+    // Decorations are matched by name, layers the map lacks are skipped.
+    std::vector<TileLayer*> decorationLayers;
+    for (const auto& decoration : data.decorations) {
+        decorationLayers.push_back(findDecorationLayer(decoration.name));
+    }
+
+    for (int row = 0; row < data.height; row++) {
+        for (int column = 0; column < data.width; column++) {
+            if (!isValidGridPosition(x + column, y + row)) continue;
+
+            int i = data.index(column, row);
+            setWalkable(x + column, y + row, data.walkable[i] != 0);
+            setTileTexture(x + column, y + row, data.getTexture(data.ground[i]));
+            setObjectTexture(x + column, y + row, data.getTexture(data.objects[i]));
+
+            for (size_t layer = 0; layer < decorationLayers.size(); layer++) {
+                if (!decorationLayers[layer]) continue;
+                setCell(decorationLayers[layer], x + column, y + row,
+                        internTexture(data.getTexture(data.decorations[layer].tiles[i])));
+            }
+        }
+    }
+}
+
+void TileMap::markDirty(int gridX, int gridY) {
+    dirtyMinX = std::min(dirtyMinX, gridX);
+    dirtyMinY = std::min(dirtyMinY, gridY);
+    dirtyMaxX = std::max(dirtyMaxX, gridX);
+    dirtyMaxY = std::max(dirtyMaxY, gridY);
+}
+
+void TileMap::markAllDirty() {
+    dirtyMinX = 0;
+    dirtyMinY = 0;
+    dirtyMaxX = gridWidth - 1;
+    dirtyMaxY = gridHeight - 1;
+}
+
+bool TileMap::takeDirtyRect(SDL_Rect& rect) {
+    if (dirtyMinX > dirtyMaxX || dirtyMinY > dirtyMaxY) {
+        return false;
+    }
+
+    rect = {dirtyMinX, dirtyMinY, dirtyMaxX - dirtyMinX + 1, dirtyMaxY - dirtyMinY + 1};
+
+    dirtyMinX = gridWidth;
+    dirtyMinY = gridHeight;
+    dirtyMaxX = -1;
+    dirtyMaxY = -1;
+    return true;
+}
+
+void TileMap::setViewOrigin(int pixelX, int pixelY) {
+    viewX = std::max(0, std::min(pixelX, gridWidth * tileSize - windowWidth));
+    viewY = std::max(0, std::min(pixelY, gridHeight * tileSize - windowHeight));
+}
+
+void TileMap::centerViewOn(int gridX, int gridY) {
+    setViewOrigin(gridX * tileSize + tileSize / 2 - windowWidth / 2,
+                  gridY * tileSize + tileSize / 2 - windowHeight / 2);
+}
+
+void TileMap::toMapData(MapData& data) const {
+    copyRegion(0, 0, gridWidth, gridHeight, data);
+    data.autotile = autotiled;
+}
@@ -1,12 +1,21 @@
 #ifndef TILEMAP_H
 #define TILEMAP_H
 
+#include <string>
 #include <vector>
-#include "tile.h"
+#include <unordered_map>
 #include "renderer.h"
+#include "map_data.h"
+#include "tile_layer.h"
+#include "visibility_field.h"
 
+// Layers are drawn bottom to top: ground, objects, decorations in the order
+// they were added, then the collision overlay. Texture layers store indices
+// into the map's palette.
 class TileMap {
 public:
+    static const int MAX_DECORATION_LAYERS = 12;
+
     TileMap(int tileSize, int windowWidth, int windowHeight);
     ~TileMap();
 
@@ -21,14 +30,77 @@ public:
     void pixelToGrid(int pixelX, int pixelY, int& gridX, int& gridY) const;
     void gridToPixel(int gridX, int gridY, int& pixelX, int& pixelY) const;
 
-    Tile* getTileAt(int gridX, int gridY);
-
     bool isValidGridPosition(int gridX, int gridY) const;
     bool isWalkable(int gridX, int gridY) const;
 
     std::vector<std::pair<int, int>> findPath(int startX, int startY, int endX, int endY) const;
 
+    TileLayer* getGroundLayer() const { return layers.front(); }
+    TileLayer* getObjectLayer() const { return layers[1]; }
+    TileLayer* getCollisionLayer() const { return layers.back(); }
+    const std::vector<TileLayer*>& getLayers() const { return layers; }
+
+    int getDecorationCount() const { return static_cast<int>(layers.size()) - 3; }
+    TileLayer* getDecorationLayer(int index) const;
+    TileLayer* findLayer(const std::string& name) const;
+    TileLayer* findDecorationLayer(const std::string& name) const;
+
+    // Returns nullptr when the name is taken or the limit is reached.
+    TileLayer* addDecorationLayer(const std::string& name);
+    void removeDecorationLayer(int index);
+
+    uint16_t internTexture(const std::string& textureID);
+    const std::string& getTexture(uint16_t paletteIndex) const;
+
+    const std::string& getGroundTexture(int gridX, int gridY) const;
+    const std::string& getObjectTexture(int gridX, int gridY) const;
+
     void setTileTexture(int gridX, int gridY, const std::string& textureID);
+    void setObjectTexture(int gridX, int gridY, const std::string& textureID);
+    void setWalkable(int gridX, int gridY, bool walkable);
+
+    // Carried over from and back to MapData, see MapData::autotile.
+    bool isAutotiled() const { return autotiled; }
+    void setAutotiled(bool value) { autotiled = value; }
+
+    // Writes a raw cell value to one of this map's layers.
+    void setCell(TileLayer* layer, int gridX, int gridY, uint16_t value);
+
+    // Fog of war viewers, sight is blocked by the collision layer and
+    // updated when it changes. Loading map data drops all viewers.
+    int addViewer(int gridX, int gridY, int radius);
+    void moveViewer(int id, int gridX, int gridY);
+    void removeViewer(int id);
+    void clearVisibility();
+    const VisibilityField& getVisibility() const { return visibility; }
+    VisibilityField& getVisibility() { return visibility; }
+
+    // Frees the layers' cached chunk textures, they are redrawn when next shown.
+    void releaseRenderCache();
+    void invalidateRenderCache();
+
+    void applyMapData(const MapData& data);
+    void toMapData(MapData& data) const;
+
+    // Rectangular blocks for copy/paste, clipped to the map.
+    void copyRegion(int x, int y, int width, int height, MapData& data) const;
+    void pasteRegion(int x, int y, const MapData& data);
+
+    // Bounding box of tiles changed since the last call, for caches such as
+    // the minimap. Writes through TileMap are tracked, callers that change a
+    // layer directly mark it themselves.
+    void markDirty(int gridX, int gridY);
+    void markAllDirty();
+    bool takeDirtyRect(SDL_Rect& rect);
+
+    // Top-left world pixel on screen. Clamped so the view never leaves the
+    // map, a map no larger than the window always sits at the origin.
+    void setViewOrigin(int pixelX, int pixelY);
+    void centerViewOn(int gridX, int gridY);
+    int getViewX() const { return viewX; }
+    int getViewY() const { return viewY; }
+    int getViewWidth() const { return windowWidth; }
+    int getViewHeight() const { return windowHeight; }
 private:
     int tileSize;
     int windowWidth;
@@ -36,7 +108,16 @@ private:
     int gridWidth;
     int gridHeight;
 
-    std::vector<std::vector<Tile*>> tiles;
+    std::vector<TileLayer*> layers;
+
+    std::vector<std::string> palette;
+    std::unordered_map<std::string, uint16_t> paletteLookup;
+
+    VisibilityField visibility;
+
+    int viewX, viewY;
+    bool autotiled;
+    int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
 
     struct PathNode {
         int x, y;
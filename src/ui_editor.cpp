@@ -759,6 +759,16 @@ bool UIEditor::loadLayout(const std::string& filename) {
         file >> layoutJson;
         file.close();
 
+        return applyLayout(layoutJson, filename);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error loading layout: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool UIEditor::applyLayout(const nlohmann::json& layoutJson, const std::string& filename) {
+    try {
         if (!layoutJson.contains("elements")) {
             std::cerr << "Invalid layout file format" << std::endl;
             return false;
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <json.hpp>
 #include "imgui/imgui.h"
 #include "renderer.h"
 #include "ui_manager.h"
@@ -28,6 +29,7 @@ public:
 
     bool saveLayout(const std::string& filename);
     bool loadLayout(const std::string& filename);
+    bool applyLayout(const nlohmann::json& layoutJson, const std::string& filename);
 
 private:
     UIManager* cityUIManager;
@@ -1,10 +1,33 @@
 #include "main.cpp"
 #include "game.cpp"
 #include "renderer.cpp"
+#include "asset_loader.cpp"
+#include "asset_manifest.cpp"
+#include "asset_archive.cpp"
+#include "mapped_file.cpp"
+#include "lz_codec.cpp"
+#include "hot_reloader.cpp"
+#include "map_data.cpp"
+#include "map_serializer.cpp"
+#include "map_cache.cpp"
+#include "map_saver.cpp"
+#include "atomic_file.cpp"
+#include "map_journal.cpp"
+#include "edit_history.cpp"
+#include "autotile.cpp"
+#include "stamp_library.cpp"
+#include "map_indexer.cpp"
+#include "minimap.cpp"
+#include "tile_overlay.cpp"
+#include "tile_layer.cpp"
+#include "visibility_field.cpp"
+#include "fog_overlay.cpp"
+#include "threat_field.cpp"
+#include "threat_overlay.cpp"
+#include "cooperative_planner.cpp"
 #include "entity.cpp"
 #include "player.cpp"
 #include "tilemap.cpp"
-#include "tile.cpp"
 #include "map_editor.cpp"
 #include "combat_manager.cpp"
 #include "enemy.cpp"
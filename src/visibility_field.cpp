@@ -0,0 +1,218 @@
+#include "visibility_field.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Octant transforms from (column, row) offsets to map offsets.
+const int OCTANTS[8][4] = {
+    { 1,  0,  0,  1},
+    { 0,  1,  1,  0},
+    { 0, -1,  1,  0},
+    {-1,  0,  0,  1},
+    {-1,  0,  0, -1},
+    { 0, -1, -1,  0},
+    { 0,  1, -1,  0},
+    { 1,  0,  0, -1}
+};
+
+bool blocksSight(const TileLayer& blockers, int gridX, int gridY) {
+    if (gridX < 0 || gridX >= blockers.getWidth() || gridY < 0 || gridY >= blockers.getHeight()) {
+        return true;
+    }
+
+    return blockers.get(gridX, gridY) == 0;
+}
+
+}
+
+VisibilityField::VisibilityField() : width(0), height(0), nextViewerId(1), castStamp(0), revision(0) {
+    dirtyMinX = 0;
+    dirtyMinY = 0;
+    dirtyMaxX = -1;
+    dirtyMaxY = -1;
+}
+
+void VisibilityField::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    castStamps.assign(static_cast<size_t>(width) * height, 0);
+    castStamp = 0;
+    clear();
+}
+
+void VisibilityField::clear() {
+    viewers.clear();
+    viewerCounts.assign(static_cast<size_t>(width) * height, 0);
+    explored.assign(static_cast<size_t>(width) * height, 0);
+
+    dirtyMinX = 0;
+    dirtyMinY = 0;
+    dirtyMaxX = width - 1;
+    dirtyMaxY = height - 1;
+    revision++;
+}
+
+int VisibilityField::addViewer(int gridX, int gridY, int radius, const TileLayer& blockers) {
+    int id = nextViewerId++;
+
+    Viewer& viewer = viewers[id];
+    viewer.x = gridX;
+    viewer.y = gridY;
+    viewer.radius = radius;
+
+    cast(viewer, blockers);
+    return id;
+}
+
+void VisibilityField::moveViewer(int id, int gridX, int gridY, const TileLayer& blockers) {
+    auto it = viewers.find(id);
+    if (it == viewers.end()) return;
+
+    Viewer& viewer = it->second;
+    if (viewer.x == gridX && viewer.y == gridY) return;
+
+    retract(viewer);
+    viewer.x = gridX;
+    viewer.y = gridY;
+    cast(viewer, blockers);
+}
+
+void VisibilityField::removeViewer(int id) {
+    auto it = viewers.find(id);
+    if (it == viewers.end()) return;
+
+    retract(it->second);
+    viewers.erase(it);
+}
+
+void VisibilityField::blockerChanged(int gridX, int gridY, const TileLayer& blockers) {
+    for (auto& pair : viewers) {
+        Viewer& viewer = pair.second;
+        if (std::abs(gridX - viewer.x) > viewer.radius || std::abs(gridY - viewer.y) > viewer.radius) continue;
+
+        retract(viewer);
+        cast(viewer, blockers);
+    }
+}
+
+bool VisibilityField::isVisible(int gridX, int gridY) const {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) {
+        return false;
+    }
+
+    return viewerCounts[static_cast<size_t>(gridY) * width + gridX] > 0;
+}
+
+bool VisibilityField::isExplored(int gridX, int gridY) const {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) {
+        return false;
+    }
+
+    return explored[static_cast<size_t>(gridY) * width + gridX] != 0;
+}
+
+bool VisibilityField::takeDirtyRect(SDL_Rect& rect) {
+    if (dirtyMinX > dirtyMaxX || dirtyMinY > dirtyMaxY) {
+        return false;
+    }
+
+    rect = {dirtyMinX, dirtyMinY, dirtyMaxX - dirtyMinX + 1, dirtyMaxY - dirtyMinY + 1};
+
+    dirtyMinX = width;
+    dirtyMinY = height;
+    dirtyMaxX = -1;
+    dirtyMaxY = -1;
+    return true;
+}
+
+void VisibilityField::retract(Viewer& viewer) {
+    for (int i : viewer.tiles) {
+        viewerCounts[i]--;
+    }
+    viewer.tiles.clear();
+    markDirty(viewer);
+}
+
+void VisibilityField::cast(Viewer& viewer, const TileLayer& blockers) {
+    if (width == 0 || height == 0) return;
+
+    // Wrapping around resets the stamps so old ones can't collide.
+    if (++castStamp == 0) {
+        std::fill(castStamps.begin(), castStamps.end(), 0);
+        castStamp = 1;
+    }
+
+    reveal(viewer, viewer.x, viewer.y);
+    for (const auto& octant : OCTANTS) {
+        castOctant(viewer, blockers, 1, 1.0f, 0.0f, octant[0], octant[1], octant[2], octant[3]);
+    }
+
+    markDirty(viewer);
+}
+
+// Walks the rows of one octant outwards from the viewer. Each row is scanned
+// from the steep end, a run of blockers splits the lit slope range and the
+// part beyond the run is cast recursively from the next row.
+void VisibilityField::castOctant(Viewer& viewer, const TileLayer& blockers, int row, float startSlope, float endSlope,
+                                 int xx, int xy, int yx, int yy) {
+    if (startSlope < endSlope) return;
+
+    int radiusSquared = viewer.radius * viewer.radius;
+    float nextStartSlope = startSlope;
+
+    for (int distance = row; distance <= viewer.radius; distance++) {
+        bool blocked = false;
+
+        for (int deltaX = -distance, deltaY = -distance; deltaX <= 0; deltaX++) {
+            float leftSlope = (deltaX - 0.5f) / (deltaY + 0.5f);
+            float rightSlope = (deltaX + 0.5f) / (deltaY - 0.5f);
+
+            if (startSlope < rightSlope) continue;
+            if (endSlope > leftSlope) break;
+
+            int gridX = viewer.x + deltaX * xx + deltaY * xy;
+            int gridY = viewer.y + deltaX * yx + deltaY * yy;
+
+            if (deltaX * deltaX + deltaY * deltaY <= radiusSquared) {
+                reveal(viewer, gridX, gridY);
+            }
+
+            bool opaque = blocksSight(blockers, gridX, gridY);
+            if (blocked) {
+                if (opaque) {
+                    nextStartSlope = rightSlope;
+                } else {
+                    blocked = false;
+                    startSlope = nextStartSlope;
+                }
+            } else if (opaque && distance < viewer.radius) {
+                blocked = true;
+                castOctant(viewer, blockers, distance + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                nextStartSlope = rightSlope;
+            }
+        }
+
+        if (blocked) break;
+    }
+}
+
+void VisibilityField::reveal(Viewer& viewer, int gridX, int gridY) {
+    if (gridX < 0 || gridX >= width || gridY < 0 || gridY >= height) return;
+
+    int i = gridY * width + gridX;
+    if (castStamps[i] == castStamp) return;
+    castStamps[i] = castStamp;
+
+    viewerCounts[i]++;
+    explored[i] = 1;
+    viewer.tiles.push_back(i);
+}
+
+void VisibilityField::markDirty(const Viewer& viewer) {
+    revision++;
+    dirtyMinX = std::max(0, std::min(dirtyMinX, viewer.x - viewer.radius));
+    dirtyMinY = std::max(0, std::min(dirtyMinY, viewer.y - viewer.radius));
+    dirtyMaxX = std::min(width - 1, std::max(dirtyMaxX, viewer.x + viewer.radius));
+    dirtyMaxY = std::min(height - 1, std::max(dirtyMaxY, viewer.y + viewer.radius));
+}
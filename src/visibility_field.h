@@ -0,0 +1,72 @@
+#ifndef VISIBILITY_FIELD_H
+#define VISIBILITY_FIELD_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "tile_layer.h"
+
+// Which tiles a set of viewers can see, for fog of war. Sight is computed
+// with recursive shadowcasting over the eight octants around each viewer;
+// cells of the blocker layer that are 0 stop sight but are seen themselves.
+//
+// Every tile counts how many viewers see it, so moving one viewer only
+// retracts its old tiles and casts again within its own radius, the rest of
+// the field is left alone. Tiles that were ever seen stay explored.
+class VisibilityField {
+public:
+    VisibilityField();
+
+    void resize(int newWidth, int newHeight);
+
+    // Returns an id for moveViewer and removeViewer.
+    int addViewer(int gridX, int gridY, int radius, const TileLayer& blockers);
+    void moveViewer(int id, int gridX, int gridY, const TileLayer& blockers);
+    void removeViewer(int id);
+    bool hasViewers() const { return !viewers.empty(); }
+
+    // Drops every viewer and forgets explored tiles.
+    void clear();
+
+    // Recasts the viewers whose radius reaches a blocker that changed.
+    void blockerChanged(int gridX, int gridY, const TileLayer& blockers);
+
+    bool isVisible(int gridX, int gridY) const;
+    bool isExplored(int gridX, int gridY) const;
+
+    // Bounding box of tiles whose visibility changed since the last call.
+    bool takeDirtyRect(SDL_Rect& rect);
+    // Bumped on every change, for readers other than the one taking the dirty rect.
+    uint32_t getRevision() const { return revision; }
+
+private:
+    struct Viewer {
+        int x, y;
+        int radius;
+        std::vector<int> tiles;
+    };
+
+    int width, height;
+    std::vector<uint16_t> viewerCounts;
+    std::vector<uint8_t> explored;
+
+    std::map<int, Viewer> viewers;
+    int nextViewerId;
+
+    // Tiles reached by the current cast are stamped so octant edges are only counted once.
+    std::vector<uint32_t> castStamps;
+    uint32_t castStamp;
+
+    int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+    uint32_t revision;
+
+    void retract(Viewer& viewer);
+    void cast(Viewer& viewer, const TileLayer& blockers);
+    void castOctant(Viewer& viewer, const TileLayer& blockers, int row, float startSlope, float endSlope,
+                    int xx, int xy, int yx, int yy);
+    void reveal(Viewer& viewer, int gridX, int gridY);
+    void markDirty(const Viewer& viewer);
+};
+
+#endif // VISIBILITY_FIELD_H
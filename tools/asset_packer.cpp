@@ -0,0 +1,182 @@
+// Offline packer: decodes every texture listed in the asset manifest, converts
+// it to the renderer's pixel format and writes a single archive the game can
+// map at startup instead of decoding PNGs.
+//
+// Usage: madventures-packer [--compress] [manifest] [output]
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_Image.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "asset_archive.h"
+#include "asset_manifest.h"
+#include "lz_codec.h"
+
+struct PackedTexture {
+    std::string id;
+    AssetArchiveEntry entry;
+    std::vector<unsigned char> data;
+};
+
+static bool packTexture(const std::string& id, const std::string& path, Uint32 pixelFormat,
+                        bool compress, PackedTexture& packed) {
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded) {
+        std::cerr << "Failed to load image " << path << ": " << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, pixelFormat, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface) {
+        std::cerr << "Failed to convert " << path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    uint32_t pitch = static_cast<uint32_t>(surface->w) * SDL_BYTESPERPIXEL(pixelFormat);
+    std::vector<unsigned char> pixels(static_cast<size_t>(pitch) * surface->h);
+
+    SDL_LockSurface(surface);
+    for (int y = 0; y < surface->h; y++) {
+        std::memcpy(pixels.data() + y * pitch,
+                    static_cast<unsigned char*>(surface->pixels) + y * surface->pitch, pitch);
+    }
+    SDL_UnlockSurface(surface);
+
+    std::memset(&packed.entry, 0, sizeof(packed.entry));
+    packed.id = id;
+    packed.entry.width = static_cast<uint32_t>(surface->w);
+    packed.entry.height = static_cast<uint32_t>(surface->h);
+    packed.entry.pitch = pitch;
+    packed.entry.rawSize = pixels.size();
+
+    SDL_FreeSurface(surface);
+
+    if (compress) {
+        std::vector<unsigned char> compressed(lzCompressBound(pixels.size()));
+        size_t compressedSize = lzCompress(pixels.data(), pixels.size(), compressed.data(), compressed.size());
+
+        // Small or noisy images can grow, keep those raw.
+        if (compressedSize > 0 && compressedSize < pixels.size()) {
+            compressed.resize(compressedSize);
+            packed.data.swap(compressed);
+            packed.entry.flags = ASSET_ARCHIVE_COMPRESSED;
+            packed.entry.storedSize = compressedSize;
+            return true;
+        }
+    }
+
+    packed.data.swap(pixels);
+    packed.entry.storedSize = packed.data.size();
+    return true;
+}
+
+static uint64_t alignTo(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool writeArchive(const std::string& filename, Uint32 pixelFormat, std::vector<PackedTexture>& textures) {
+    std::string strings;
+    for (auto& texture : textures) {
+        texture.entry.nameOffset = static_cast<uint32_t>(strings.size());
+        texture.entry.nameLength = static_cast<uint32_t>(texture.id.size());
+        strings += texture.id;
+    }
+
+    AssetArchiveHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.pixelFormat = pixelFormat;
+    header.entryCount = static_cast<uint32_t>(textures.size());
+    header.entryOffset = sizeof(AssetArchiveHeader);
+    header.stringTableOffset = header.entryOffset + header.entryCount * sizeof(AssetArchiveEntry);
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+    uint64_t dataOffset = alignTo(header.stringTableOffset + header.stringTableSize, 16);
+    for (auto& texture : textures) {
+        texture.entry.dataOffset = dataOffset;
+        dataOffset = alignTo(dataOffset + texture.entry.storedSize, 16);
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& texture : textures) {
+        file.write(reinterpret_cast<const char*>(&texture.entry), sizeof(texture.entry));
+    }
+    file.write(strings.data(), strings.size());
+
+    const char padding[16] = {};
+    for (const auto& texture : textures) {
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, texture.entry.dataOffset - position);
+        file.write(reinterpret_cast<const char*>(texture.data.data()), texture.data.size());
+    }
+
+    return file.good();
+}
+
+int main(int argc, char* argv[]) {
+    bool compress = false;
+    std::string manifestPath = "assets/manifest.json";
+    std::string outputPath = "assets/assets.pak";
+
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    if (positional.size() > 0) manifestPath = positional[0];
+    if (positional.size() > 1) outputPath = positional[1];
+
+    // ARGB8888 is what the SDL renderers list first, so textures upload without conversion.
+    const Uint32 pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+
+    AssetManifest manifest;
+    if (!manifest.load(manifestPath)) {
+        return 1;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        std::cerr << "SDL_Image could not initialize! SDL_Image Error: " << IMG_GetError() << std::endl;
+        return 1;
+    }
+
+    std::vector<PackedTexture> textures;
+    uint64_t rawBytes = 0;
+    uint64_t storedBytes = 0;
+
+    for (const auto& entry : manifest.getTextures()) {
+        PackedTexture packed;
+        if (!packTexture(entry.first, entry.second, pixelFormat, compress, packed)) {
+            continue;
+        }
+
+        rawBytes += packed.entry.rawSize;
+        storedBytes += packed.entry.storedSize;
+        textures.push_back(std::move(packed));
+    }
+
+    IMG_Quit();
+
+    if (!writeArchive(outputPath, pixelFormat, textures)) {
+        std::cerr << "Failed to write archive " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << textures.size() << " textures into " << outputPath
+              << " (" << storedBytes << " of " << rawBytes << " bytes)" << std::endl;
+    return 0;
+}
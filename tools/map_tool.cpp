@@ -0,0 +1,319 @@
+// Batch tool for map files, runs without SDL so it can be used on build machines.
+//
+// Usage: madventures-maptool <command> [options] <path>...
+//
+// Commands:
+//   convert --to json|bmap   write each map next to the input in the other format
+//   reencode                 rewrite each map in place with the current schema
+//   stats                    walkable tiles, connected regions and reachability
+//   lint                     report texture ids missing from the asset manifest and
+//                            autotiled maps whose borders the load pass would change
+//
+// Options:
+//   -j <count>               worker threads, defaults to the number of cores
+//   --manifest <file>        manifest used by lint, defaults to assets/manifest.json
+//
+// Directories expand to every *.json and *.bmap file inside them. Maps are
+// processed in parallel but reports are printed in input order.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asset_manifest.h"
+#include "autotile.h"
+#include "map_serializer.h"
+
+struct ToolOptions {
+    std::string command;
+    std::string targetFormat;
+    std::string manifestPath = "assets/manifest.json";
+    int jobCount = 0;
+    std::vector<std::string> files;
+};
+
+struct MapReport {
+    bool success = true;
+    std::string text;
+};
+
+static void printUsage() {
+    std::cerr << "Usage: madventures-maptool <command> [options] <path>..." << std::endl;
+    std::cerr << "Commands: convert --to json|bmap, reencode, stats, lint" << std::endl;
+    std::cerr << "Options:  -j <count>, --manifest <file>" << std::endl;
+}
+
+static bool isMapFile(const std::filesystem::path& path) {
+    return path.extension() == ".json" || path.extension() == ".bmap";
+}
+
+static bool collectFiles(const std::string& path, std::vector<std::string>& files) {
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+            if (entry.is_regular_file() && isMapFile(entry.path())) {
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+        return true;
+    }
+
+    if (!std::filesystem::exists(path, error)) {
+        std::cerr << "No such file or directory: " << path << std::endl;
+        return false;
+    }
+
+    files.push_back(path);
+    return true;
+}
+
+static MapReport convertMap(const std::string& filename, const MapData& data, const std::string& format) {
+    MapReport report;
+
+    std::filesystem::path output = filename;
+    output.replace_extension(format == "bmap" ? ".bmap" : ".json");
+
+    if (output == std::filesystem::path(filename)) {
+        report.text = filename + ": already " + format;
+        return report;
+    }
+
+    report.success = MapSerializer::save(output.string(), data);
+    report.text = filename + " -> " + output.string() + (report.success ? "" : " FAILED");
+    return report;
+}
+
+static MapReport reencodeMap(const std::string& filename, const MapData& data) {
+    MapReport report;
+
+    std::error_code error;
+    uintmax_t sizeBefore = std::filesystem::file_size(filename, error);
+
+    report.success = MapSerializer::save(filename, data);
+    if (!report.success) {
+        report.text = filename + ": FAILED to write";
+        return report;
+    }
+
+    uintmax_t sizeAfter = std::filesystem::file_size(filename, error);
+    report.text = filename + ": " + std::to_string(sizeBefore) + " -> " + std::to_string(sizeAfter) + " bytes";
+    return report;
+}
+
+// Labels 4-connected regions of walkable tiles and reports how much of the
+// walkable area the largest region covers. Anything outside it cannot be
+// reached from the main play area.
+static MapReport mapStats(const std::string& filename, const MapData& data) {
+    MapReport report;
+
+    size_t count = static_cast<size_t>(data.width) * data.height;
+    std::vector<int> region(count, -1);
+    std::vector<int> stack;
+
+    int walkableCount = 0;
+    int regionCount = 0;
+    int largestRegion = 0;
+    int isolatedTiles = 0;
+
+    for (size_t start = 0; start < count; start++) {
+        if (!data.walkable[start] || region[start] >= 0) continue;
+
+        int size = 0;
+        region[start] = regionCount;
+        stack.push_back(static_cast<int>(start));
+
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+            size++;
+
+            int x = i % data.width;
+            int y = i / data.width;
+            const int offsets[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+            for (const auto& offset : offsets) {
+                int nx = x + offset[0];
+                int ny = y + offset[1];
+                if (!data.contains(nx, ny)) continue;
+
+                int neighbour = data.index(nx, ny);
+                if (data.walkable[neighbour] && region[neighbour] < 0) {
+                    region[neighbour] = regionCount;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+
+        walkableCount += size;
+        largestRegion = std::max(largestRegion, size);
+        if (size == 1) isolatedTiles++;
+        regionCount++;
+    }
+
+    std::ostringstream text;
+    text << filename << ": " << data.width << "x" << data.height
+         << ", " << walkableCount << "/" << count << " walkable"
+         << ", " << regionCount << " regions"
+         << ", largest " << largestRegion;
+
+    if (walkableCount > 0) {
+        text << " (" << (largestRegion * 100 / walkableCount) << "% reachable)";
+    }
+    if (isolatedTiles > 0) {
+        text << ", " << isolatedTiles << " isolated tiles";
+    }
+
+    report.text = text.str();
+    return report;
+}
+
+static MapReport lintMap(const std::string& filename, const MapData& data, const AssetManifest& manifest) {
+    MapReport report;
+
+    std::vector<int> uses(data.palette.size(), 0);
+    for (uint16_t value : data.ground) {
+        if (value < uses.size()) uses[value]++;
+    }
+    for (uint16_t value : data.objects) {
+        if (value < uses.size()) uses[value]++;
+    }
+    for (const auto& layer : data.decorations) {
+        for (uint16_t value : layer.tiles) {
+            if (value < uses.size()) uses[value]++;
+        }
+    }
+
+    std::ostringstream text;
+    text << filename << ":";
+
+    for (size_t i = 1; i < data.palette.size(); i++) {
+        if (uses[i] == 0 || manifest.hasTexture(data.palette[i])) continue;
+
+        report.success = false;
+        text << "\n    unknown texture '" << data.palette[i] << "' on " << uses[i] << " tiles";
+    }
+
+    // Loading runs the same pass, any change here would show up in game as
+    // borders different from the ones saved.
+    MapData autotiled = data;
+    int changedBorders = Autotiler::updateMap(autotiled);
+    if (changedBorders > 0) {
+        report.success = false;
+        text << "\n    autotiling changes " << changedBorders << " border tiles on load";
+    }
+
+    if (report.success) {
+        text << " ok";
+    }
+
+    report.text = text.str();
+    return report;
+}
+
+static MapReport processMap(const std::string& filename, const ToolOptions& options, const AssetManifest& manifest) {
+    MapData data;
+    if (!MapSerializer::load(filename, data)) {
+        return {false, filename + ": FAILED to load"};
+    }
+
+    if (options.command == "convert") {
+        return convertMap(filename, data, options.targetFormat);
+    }
+    if (options.command == "reencode") {
+        return reencodeMap(filename, data);
+    }
+    if (options.command == "stats") {
+        return mapStats(filename, data);
+    }
+    return lintMap(filename, data, manifest);
+}
+
+static bool parseOptions(int argc, char* argv[], ToolOptions& options) {
+    if (argc < 2) return false;
+    options.command = argv[1];
+
+    if (options.command != "convert" && options.command != "reencode" &&
+        options.command != "stats" && options.command != "lint") {
+        std::cerr << "Unknown command: " << options.command << std::endl;
+        return false;
+    }
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-j" && i + 1 < argc) {
+            options.jobCount = std::atoi(argv[++i]);
+        } else if (arg == "--to" && i + 1 < argc) {
+            options.targetFormat = argv[++i];
+        } else if (arg == "--manifest" && i + 1 < argc) {
+            options.manifestPath = argv[++i];
+        } else if (!collectFiles(arg, options.files)) {
+            return false;
+        }
+    }
+
+    if (options.command == "convert" && options.targetFormat != "json" && options.targetFormat != "bmap") {
+        std::cerr << "convert needs --to json or --to bmap" << std::endl;
+        return false;
+    }
+
+    return !options.files.empty();
+}
+
+int main(int argc, char* argv[]) {
+    ToolOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    AssetManifest manifest;
+    if (options.command == "lint" && !manifest.load(options.manifestPath)) {
+        std::cerr << "Failed to load manifest: " << options.manifestPath << std::endl;
+        return 1;
+    }
+
+    int jobCount = options.jobCount;
+    if (jobCount <= 0) {
+        jobCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    jobCount = std::min(jobCount, static_cast<int>(options.files.size()));
+
+    // Workers pull the next file index, each report has its own slot so no locking is needed.
+    std::vector<MapReport> reports(options.files.size());
+    std::atomic<size_t> nextFile(0);
+
+    auto worker = [&]() {
+        for (size_t i = nextFile++; i < options.files.size(); i = nextFile++) {
+            reports[i] = processMap(options.files[i], options, manifest);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < jobCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    int failures = 0;
+    for (const auto& report : reports) {
+        if (report.success) {
+            std::cout << report.text << std::endl;
+        } else {
+            std::cerr << report.text << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << options.files.size() << " maps, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}